@@ -3,242 +3,159 @@
 #define ANDRES_GRAPH_MULTICUT_LIFTED_GREEDY_CUTMIN_HXX
 
 #include <cstddef>
-#include <iterator>
+#include <limits>
 #include <vector>
-#include <algorithm>
-#include <map>
-#include <queue>
 
-#include "andres/partition.hxx"
+#include "andres/graph/multicut-lifted/BEC_core.hxx"
+#include "andres/graph/multicut-lifted/BEC_incremental.hxx"
+#include "andres/graph/multicut-lifted/BEC_precontraction.hxx"
+#include "andres/graph/multicut-lifted/BEC_tiled.hxx"
 
 namespace andres {
     namespace graph {
         namespace multicut_lifted {
 
-            /// Greedy balanced agglomerative decomposition of a graph. (BEC)
-            ///
-            template<typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename ELA>
-                void balancedEdgeContraction(
-                        const ORIGGRAPH& original_graph,
-                        const LIFTGRAPH& lifted_graph,
-                        EVA const& edge_values,
-                        ELA& edge_labels
-                        )
-                { 
-                    class DynamicGraph
+            namespace detail {
+
+                /// Priorities of BEC: the cost of an edge divided by the balancing term.
+                ///
+                template<typename VALUE_TYPE>
+                    class BalancedContractionRule
                     {
                         public:
-                            DynamicGraph(size_t n) :
-                                vertices_(n),
-                                vertex_weights_(n)
-                        {}
-
-                            bool edgeExists(size_t a, size_t b) const
+                            struct Edge
                             {
-                                return !vertices_[a].empty() && vertices_[a].find(b) != vertices_[a].end();
-                            }
+                                Edge(VALUE_TYPE _w = VALUE_TYPE())
+                                {
+                                    w = _w;
+                                }
 
-                            std::map<size_t, typename EVA::value_type> const& getAdjacentVertices(size_t v) const
-                            {
-                                return vertices_[v];
-                            }
+                                VALUE_TYPE w;
 
-                            typename EVA::value_type getEdgeWeight(size_t a, size_t b) const
-                            {
-                                return vertices_[a].at(b);
-                            }
+                                bool operator <(Edge const& other) const
+                                {
+                                    return w < other.w;
+                                }
+                            };
 
-                            void removeVertex(size_t v)
-                            {
-                                for (auto& p : vertices_[v])
-                                    vertices_[p.first].erase(v);
+                            BalancedContractionRule(size_t)
+                            {}
 
-                                vertices_[v].clear();
-                            }
+                            void addCost(size_t, size_t, VALUE_TYPE)
+                            {}
 
-                            void setEdgeWeight(size_t a, size_t b, typename EVA::value_type w)
+                            Edge initialPriority(size_t, size_t, VALUE_TYPE c) const
                             {
-                                vertices_[a][b] = w;
-                                vertices_[b][a] = w;
+                                return Edge(c);
                             }
 
-                            void setVertexWeights(size_t a, typename EVA::value_type w)
-                            {
-                                vertex_weights_[a] = w;  
-                            }
+                            void merge(size_t, size_t, Edge const&)
+                            {}
 
-                            typename EVA::value_type returnVertexWeights(size_t a)
-                            {
-                                return vertex_weights_[a];
-                            }
+                            void reset(size_t, VALUE_TYPE)
+                            {}
 
-                            void printVertexWeights(size_t a)
+                            Edge priority(size_t, size_t, VALUE_TYPE c, VALUE_TYPE wn) const
                             {
-                                std::cout<< vertex_weights_[a]<<" "<<std::flush;
+                                return Edge(c/wn);
                             }
-
-                        private:
-                            std::vector<std::map<size_t, typename EVA::value_type>> vertices_;
-                            std::vector<typename EVA::value_type> vertex_weights_;
-                    };
-
-                    struct Edge
-                    {
-                        Edge(size_t _a, size_t _b, typename EVA::value_type _wp, typename EVA::value_type _w)
-                        {
-                            if (_a > _b)
-                                std::swap(_a, _b);
-
-                            a = _a;
-                            b = _b;
-                            wp=_wp;
-                            w = _w;
-                        }
-
-                        size_t a;
-                        size_t b;
-                        size_t edition;
-                        typename EVA::value_type w;
-                        typename EVA::value_type wp;
-
-                        bool operator <(Edge const& other) const
-                        {
-                            return w < other.w;
-                        }
                     };
 
-                    std::vector<std::map<size_t, size_t>> edge_editions(original_graph.numberOfVertices());
-                    DynamicGraph original_graph_cp(original_graph.numberOfVertices());   
-                    DynamicGraph lifted_graph_cp(original_graph.numberOfVertices());
-
-                    std::priority_queue<Edge> Q;
-
-                    for (size_t i = 0; i < original_graph.numberOfEdges(); ++i)
-                    {
-                        auto a = original_graph.vertexOfEdge(i, 0);
-                        auto b = original_graph.vertexOfEdge(i, 1);
-
-                        original_graph_cp.setEdgeWeight(a, b, 1.);
-                    }
-
-
-                    for (size_t i = 0; i < lifted_graph.numberOfVertices(); ++i)
-                        lifted_graph_cp.setVertexWeights(i,1.0);
+            } // namespace detail
 
-
-                    for (size_t i = 0; i < lifted_graph.numberOfEdges(); ++i)
+            /// Greedy balanced agglomerative decomposition of a graph. (BEC)
+            ///
+            /// See BalancedEdgeContractionSettings for the parallel mode and the
+            /// pre-contraction, and BalancedEdgeContractionVisitor for the callbacks
+            /// VISITOR receives. POLICY selects the index and value types of the
+            /// contraction state, e.g. balancedEdgeContraction<CompactContractionPolicy>(...)
+            /// for about half the memory.
+            ///
+            template<typename POLICY = ContractionPolicy<>, typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename ELA, typename VISITOR>
+                void balancedEdgeContraction(
+                        const ORIGGRAPH& original_graph,
+                        const LIFTGRAPH& lifted_graph,
+                        EVA const& edge_values,
+                        ELA& edge_labels,
+                        BalancedEdgeContractionSettings const& settings,
+                        VISITOR& visitor
+                        )
+                { 
+                    if (settings.preContractionThreshold < std::numeric_limits<double>::infinity())
                     {
-                        auto a = lifted_graph.vertexOfEdge(i, 0);
-                        auto b = lifted_graph.vertexOfEdge(i, 1);
-                        lifted_graph_cp.setEdgeWeight(a, b, edge_values[i]);
-                        if (original_graph_cp.edgeExists(a, b))
-                        {
-                            auto e = Edge(a, b, edge_values[i],  edge_values[i]);
-                            e.edition = ++edge_editions[e.a][e.b];
-                            Q.push(e);
-                        }
+                        detail::preContractedBalancedEdgeContraction<POLICY, detail::BalancedContractionRule<typename POLICY::value_type>>(
+                                original_graph, lifted_graph, edge_values, edge_labels, settings, visitor);
+                        return;
                     }
 
-                    std::cout<<"graph initialized"<<std::endl;
-
-                    andres::Partition<size_t> partition(original_graph.numberOfVertices());
-
-                    float nmerges=0;
-                    while (!Q.empty())
-                    {
-                        auto edge = Q.top();
-                        Q.pop();
-
-                        if (!original_graph_cp.edgeExists(edge.a, edge.b) || edge.edition < edge_editions[edge.a][edge.b])
-                            continue;
+                    detail::BalancedEdgeContraction<POLICY, ORIGGRAPH, LIFTGRAPH, EVA, detail::BalancedContractionRule<typename POLICY::value_type>, VISITOR>
+                        bec(original_graph, lifted_graph, edge_values, visitor);
 
-                        if (edge.w < typename EVA::value_type())
-                            break;
-
-                        nmerges++;
-
-                        auto stable_vertex = edge.a;
-                        auto merge_vertex = edge.b;
-
-                        if (lifted_graph_cp.getAdjacentVertices(stable_vertex).size() < lifted_graph_cp.getAdjacentVertices(merge_vertex).size())
-                            std::swap(stable_vertex, merge_vertex);
-
-                        partition.merge(stable_vertex, merge_vertex);
-
-                        for (auto& p : original_graph_cp.getAdjacentVertices(merge_vertex))
-                        {
-                            if (p.first == stable_vertex)
-                                continue;
-
-                            original_graph_cp.setEdgeWeight(stable_vertex, p.first, 1.);
-                        }
-
-                        original_graph_cp.removeVertex(merge_vertex);
-                        auto nwa = typename EVA::value_type(); 
-                        auto nwb = typename EVA::value_type();
-                        nwa = lifted_graph_cp.returnVertexWeights(stable_vertex);
-                        nwb = lifted_graph_cp.returnVertexWeights(merge_vertex);
-
-                        lifted_graph_cp.setVertexWeights(stable_vertex,nwa + nwb);
-
-                        for (auto& p : lifted_graph_cp.getAdjacentVertices(stable_vertex))
-                        {
-                            if (p.first == merge_vertex)
-                                continue;
-
-                            auto nwp = typename EVA::value_type();
-                            nwp =  lifted_graph_cp.returnVertexWeights(p.first);
-
-                            auto tp = typename EVA::value_type();
-                            if(lifted_graph_cp.edgeExists(merge_vertex, p.first))
-                                continue;
-
-                            float wn = (nwa+nwb+nwp)/(static_cast<float>(original_graph.numberOfVertices())/nmerges);
-                            if (original_graph_cp.edgeExists(stable_vertex, p.first))
-                            {
-                                auto e = Edge(stable_vertex, p.first, p.second + tp, (p.second +tp)/wn);
-
-                                e.edition = ++edge_editions[e.a][e.b];
-
-                                Q.push(e);
-                            }
-                        }
-
-                        for (auto& p : lifted_graph_cp.getAdjacentVertices(merge_vertex))
-                        {
-                            if (p.first == stable_vertex)
-                                continue;
-
-                            auto nwp = typename EVA::value_type();
-                            nwp =  lifted_graph_cp.returnVertexWeights(p.first);
-
-                            auto tp = typename EVA::value_type();
-                            if(lifted_graph_cp.edgeExists(stable_vertex, p.first))
-                                tp = lifted_graph_cp.getEdgeWeight(stable_vertex, p.first);
-                            else
-                                tp=0;
-                            lifted_graph_cp.setEdgeWeight(stable_vertex, p.first, p.second + tp);
+                    bec.run(settings);
+                    bec.labelEdges(edge_labels);
+                }
 
-                            float wn = (nwa+nwb+nwp)/(static_cast<float>(original_graph.numberOfVertices())/nmerges);
-                            if (original_graph_cp.edgeExists(stable_vertex, p.first))
-                            {
-                                auto e = Edge(stable_vertex, p.first, p.second + tp, (p.second +tp)/wn);
+            template<typename POLICY = ContractionPolicy<>, typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename ELA>
+                void balancedEdgeContraction(
+                        const ORIGGRAPH& original_graph,
+                        const LIFTGRAPH& lifted_graph,
+                        EVA const& edge_values,
+                        ELA& edge_labels,
+                        BalancedEdgeContractionSettings const& settings = BalancedEdgeContractionSettings()
+                        )
+                { 
+                    BalancedEdgeContractionVisitor visitor;
+                    balancedEdgeContraction<POLICY>(original_graph, lifted_graph, edge_values, edge_labels, settings, visitor);
+                }
 
-                                e.edition = ++edge_editions[e.a][e.b];
+            /// Tiled BEC for grid graphs that are too large to be contracted as a whole.
+            ///
+            /// Tiles are contracted in parallel and their clusters joined by a final
+            /// contraction with the given settings; see BalancedEdgeContractionTiling and
+            /// detail::tiledBalancedEdgeContraction.
+            ///
+            template<typename POLICY = ContractionPolicy<>, typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename ELA, typename VISITOR>
+                void balancedEdgeContraction_tiled(
+                        const ORIGGRAPH& original_graph,
+                        const LIFTGRAPH& lifted_graph,
+                        EVA const& edge_values,
+                        ELA& edge_labels,
+                        BalancedEdgeContractionTiling const& tiling,
+                        BalancedEdgeContractionSettings const& settings,
+                        VISITOR& visitor
+                        )
+                {
+                    detail::tiledBalancedEdgeContraction<POLICY, detail::BalancedContractionRule<typename POLICY::value_type>>(
+                            original_graph, lifted_graph, edge_values, edge_labels, tiling, settings, visitor);
+                }
 
-                                Q.push(e);
-                            }
-                        }
+            template<typename POLICY = ContractionPolicy<>, typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename ELA>
+                void balancedEdgeContraction_tiled(
+                        const ORIGGRAPH& original_graph,
+                        const LIFTGRAPH& lifted_graph,
+                        EVA const& edge_values,
+                        ELA& edge_labels,
+                        BalancedEdgeContractionTiling const& tiling,
+                        BalancedEdgeContractionSettings const& settings = BalancedEdgeContractionSettings()
+                        )
+                {
+                    BalancedEdgeContractionVisitor visitor;
+                    balancedEdgeContraction_tiled<POLICY>(original_graph, lifted_graph, edge_values, edge_labels, tiling, settings, visitor);
+                }
 
-                        lifted_graph_cp.removeVertex(merge_vertex);
-                    }
 
-                    for (size_t i = 0; i < lifted_graph.numberOfEdges(); ++i)
-                        edge_labels[i] = partition.find(lifted_graph.vertexOfEdge(i, 0)) == partition.find(lifted_graph.vertexOfEdge(i, 1)) ? 0 : 1;
-                }
+            /// BEC that keeps its state between solves, for sequences of instances that
+            /// differ in a few costs (video, interactive segmentation), and can start from
+            /// a given partition; see detail::IncrementalBalancedEdgeContraction.
+            ///
+            /// POLICY comes first, as for the other solvers, but an alias template cannot
+            /// default it: IncrementalBalancedEdgeContraction<ContractionPolicy<>, Graph, Graph>.
+            ///
+            template<typename POLICY, typename ORIGGRAPH, typename LIFTGRAPH, typename VISITOR = BalancedEdgeContractionVisitor>
+                using IncrementalBalancedEdgeContraction = detail::IncrementalBalancedEdgeContraction<POLICY, ORIGGRAPH, LIFTGRAPH, detail::BalancedContractionRule<typename POLICY::value_type>, VISITOR>;
 
         } // namespace multicut_lifted 
     } // namespace graph
 } // namespace andres
 
-#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_GREEDY_CUTMIN_HXX
\ No newline at end of file
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_GREEDY_CUTMIN_HXX
@@ -0,0 +1,265 @@
+#pragma once
+#ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_CLUSTER_HXX
+#define ANDRES_GRAPH_MULTICUT_LIFTED_BEC_CLUSTER_HXX
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "andres/graph/multicut-lifted/BEC_graph.hxx"
+#include "andres/graph/multicut-lifted/BEC_parallel.hxx"
+#include "andres/graph/multicut-lifted/BEC_partition.hxx"
+
+namespace andres {
+    namespace graph {
+        namespace multicut_lifted {
+
+            namespace detail {
+
+                /// Numbers the sets of partition in the order of their smallest element,
+                /// which is their root. labels[v] is set to the number of the set of v,
+                /// and the number of sets is returned.
+                inline std::size_t numberClusters(ConcurrentPartition& partition, std::vector<std::size_t>& labels, ThreadPool& pool)
+                {
+                    auto const n = partition.numberOfElements();
+                    auto const chunks = pool.numberOfThreads();
+                    auto const chunk_size = (n + chunks - 1) / chunks;
+
+                    labels.resize(n);
+                    std::vector<std::size_t> counts(chunks, 0);
+                    pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                            {
+                            auto const end = std::min(n, (c + 1) * chunk_size);
+                            for (auto v = c * chunk_size; v < end; ++v)
+                            {
+                                labels[v] = partition.find(v);
+                                if (labels[v] == v)
+                                    ++counts[c];
+                            }
+                            });
+
+                    std::size_t k = 0;
+                    for (std::size_t c = 0; c < chunks; ++c)
+                    {
+                        auto const count = counts[c];
+                        counts[c] = k;
+                        k += count;
+                    }
+
+                    // with singletons only, every vertex is its own root and its own number
+                    if (k != n)
+                    {
+                        std::vector<std::size_t> ids(n);
+                        pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                {
+                                auto const end = std::min(n, (c + 1) * chunk_size);
+                                for (auto v = c * chunk_size; v < end; ++v)
+                                    if (labels[v] == v)
+                                        ids[v] = counts[c]++;
+                                });
+                        pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                {
+                                auto const end = std::min(n, (c + 1) * chunk_size);
+                                for (auto v = c * chunk_size; v < end; ++v)
+                                    labels[v] = ids[labels[v]];
+                                });
+                    }
+
+                    return k;
+                }
+
+                /// Edges of a graph between different clusters, in CSR form.
+                ///
+                /// Every edge is listed at its smaller cluster, as the larger cluster and
+                /// the index of the edge. The lists are filled concurrently and then
+                /// sorted, by larger cluster and edge index, so they do not depend on the
+                /// number of threads.
+                ///
+                struct ClusterEdges
+                {
+                    typedef std::pair<std::size_t, std::size_t> Entry;
+
+                    template<typename GRAPH>
+                        ClusterEdges(GRAPH const& graph, std::vector<std::size_t> const& labels, std::size_t numberOfClusters, ThreadPool& pool) :
+                            offsets(numberOfClusters + 1, 0)
+                        {
+                            auto const chunks = pool.numberOfThreads();
+                            auto const chunk_size = (graph.numberOfEdges() + chunks - 1) / chunks;
+                            std::vector<std::atomic<std::size_t>> next(numberOfClusters);
+                            for (auto& n : next)
+                                n.store(0, std::memory_order_relaxed);
+
+                            pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                    {
+                                    auto const end = std::min(graph.numberOfEdges(), (c + 1) * chunk_size);
+                                    for (auto e = c * chunk_size; e < end; ++e)
+                                    {
+                                        auto const a = labels[graph.vertexOfEdge(e, 0)];
+                                        auto const b = labels[graph.vertexOfEdge(e, 1)];
+                                        if (a != b)
+                                            next[std::min(a, b)].fetch_add(1, std::memory_order_relaxed);
+                                    }
+                                    });
+
+                            for (std::size_t a = 0; a < numberOfClusters; ++a)
+                            {
+                                offsets[a + 1] = offsets[a] + next[a].load(std::memory_order_relaxed);
+                                next[a].store(offsets[a], std::memory_order_relaxed);
+                            }
+                            entries.resize(offsets.back());
+
+                            pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                    {
+                                    auto const end = std::min(graph.numberOfEdges(), (c + 1) * chunk_size);
+                                    for (auto e = c * chunk_size; e < end; ++e)
+                                    {
+                                        auto const a = labels[graph.vertexOfEdge(e, 0)];
+                                        auto const b = labels[graph.vertexOfEdge(e, 1)];
+                                        if (a != b)
+                                            entries[next[std::min(a, b)].fetch_add(1, std::memory_order_relaxed)] = Entry(std::max(a, b), e);
+                                    }
+                                    });
+
+                            auto const clusters_per_chunk = (numberOfClusters + chunks - 1) / chunks;
+                            pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                    {
+                                    auto const end = std::min(numberOfClusters, (c + 1) * clusters_per_chunk);
+                                    for (auto a = c * clusters_per_chunk; a < end; ++a)
+                                        std::sort(entries.begin() + offsets[a], entries.begin() + offsets[a + 1]);
+                                    });
+                        }
+
+                    std::vector<std::size_t> offsets;
+                    std::vector<Entry> entries;
+                };
+
+                /// Original and lifted graph of a clustering, with the size of every cluster
+                /// and the summed lifted costs between clusters, as the input of a
+                /// contraction that continues from the clusters (see BalancedEdgeContraction).
+                ///
+                /// Every pair of adjacent clusters is one edge, ordered by smaller and larger
+                /// cluster, and its cost is summed in edge order. All steps run on the
+                /// threads of pool; the result does not depend on their number.
+                ///
+                template<typename VALUE_TYPE>
+                    struct ClusterGraphs
+                    {
+                        typedef VALUE_TYPE value_type;
+                        typedef std::vector<value_type> Costs;
+
+                        ClusterGraphs()
+                        {}
+
+                        template<typename ORIGGRAPH, typename LIFTGRAPH, typename EVA>
+                            ClusterGraphs(
+                                    const ORIGGRAPH& original_graph,
+                                    const LIFTGRAPH& lifted_graph,
+                                    EVA const& edge_values,
+                                    std::vector<std::size_t> const& labels,
+                                    std::size_t numberOfClusters,
+                                    ThreadPool& pool
+                                    ) :
+                                original(numberOfClusters),
+                                lifted(numberOfClusters),
+                                sizes(numberOfClusters)
+                            {
+                                auto const n = labels.size();
+                                auto const chunks = pool.numberOfThreads();
+                                auto const chunk_size = (n + chunks - 1) / chunks;
+
+                                {
+                                    std::vector<std::atomic<std::size_t>> counts(numberOfClusters);
+                                    for (auto& count : counts)
+                                        count.store(0, std::memory_order_relaxed);
+
+                                    pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                            {
+                                            auto const end = std::min(n, (c + 1) * chunk_size);
+                                            for (auto v = c * chunk_size; v < end; ++v)
+                                                counts[labels[v]].fetch_add(1, std::memory_order_relaxed);
+                                            });
+
+                                    auto const clusters_per_chunk = (numberOfClusters + chunks - 1) / chunks;
+                                    pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                            {
+                                            auto const end = std::min(numberOfClusters, (c + 1) * clusters_per_chunk);
+                                            for (auto a = c * clusters_per_chunk; a < end; ++a)
+                                                sizes[a] = static_cast<value_type>(counts[a].load(std::memory_order_relaxed));
+                                            });
+                                }
+
+                                build(original_graph, static_cast<Costs const*>(nullptr), labels, pool, original, nullptr);
+                                build(lifted_graph, &edge_values, labels, pool, lifted, &costs);
+                            }
+
+                        TileGraph original;
+                        TileGraph lifted;
+                        Costs costs;
+                        std::vector<value_type> sizes;
+
+                    private:
+                        /// Writes one edge of cluster_graph per pair of adjacent clusters and, if
+                        /// cluster_costs is given, the summed costs of the edges joining them.
+                        template<typename GRAPH, typename EVA>
+                            static void build(
+                                    GRAPH const& graph,
+                                    EVA const* edge_values,
+                                    std::vector<std::size_t> const& labels,
+                                    ThreadPool& pool,
+                                    TileGraph& cluster_graph,
+                                    Costs* cluster_costs
+                                    )
+                            {
+                                auto const k = cluster_graph.numberOfVertices();
+                                ClusterEdges const edges(graph, labels, k, pool);
+
+                                // every thread counts and then writes the pairs of one range of clusters
+                                auto const chunks = pool.numberOfThreads();
+                                auto const clusters_per_chunk = (k + chunks - 1) / chunks;
+                                auto const first = [&](std::size_t a, std::size_t i)
+                                {
+                                    return i == edges.offsets[a] || edges.entries[i].first != edges.entries[i - 1].first;
+                                };
+
+                                std::vector<std::size_t> offsets(chunks + 1, 0);
+                                pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                        {
+                                        auto const end = std::min(k, (c + 1) * clusters_per_chunk);
+                                        for (auto a = c * clusters_per_chunk; a < end; ++a)
+                                            for (auto i = edges.offsets[a]; i < edges.offsets[a + 1]; ++i)
+                                                if (first(a, i))
+                                                    ++offsets[c + 1];
+                                        });
+
+                                for (std::size_t c = 0; c < chunks; ++c)
+                                    offsets[c + 1] += offsets[c];
+
+                                cluster_graph.resize(offsets.back());
+                                if (cluster_costs != nullptr)
+                                    cluster_costs->assign(offsets.back(), value_type());
+
+                                pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                        {
+                                        auto const end = std::min(k, (c + 1) * clusters_per_chunk);
+                                        auto p = offsets[c];
+                                        for (auto a = c * clusters_per_chunk; a < end; ++a)
+                                            for (auto i = edges.offsets[a]; i < edges.offsets[a + 1]; ++i)
+                                            {
+                                                if (first(a, i))
+                                                    cluster_graph.setEdge(p++, a, edges.entries[i].first);
+                                                if (cluster_costs != nullptr)
+                                                    (*cluster_costs)[p - 1] += static_cast<value_type>((*edge_values)[edges.entries[i].second]);
+                                            }
+                                        });
+                            }
+                    };
+
+            } // namespace detail
+
+        } // namespace multicut_lifted
+    } // namespace graph
+} // namespace andres
+
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_CLUSTER_HXX
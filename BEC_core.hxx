@@ -0,0 +1,754 @@
+#pragma once
+#ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_CORE_HXX
+#define ANDRES_GRAPH_MULTICUT_LIFTED_BEC_CORE_HXX
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "andres/graph/multicut-lifted/BEC_graph.hxx"
+#include "andres/graph/multicut-lifted/BEC_partition.hxx"
+#include "andres/graph/multicut-lifted/BEC_queue.hxx"
+#include "andres/graph/multicut-lifted/BEC_parallel.hxx"
+#include "andres/graph/multicut-lifted/BEC_visitor.hxx"
+
+namespace andres {
+    namespace graph {
+        namespace multicut_lifted {
+
+            /// Settings of BEC and BEC-cut.
+            ///
+            /// numberOfThreads == 1 (the default) runs the sequential greedy contraction.
+            /// Any other value selects batched contraction: each round takes up to
+            /// batchSize candidates from the top of the queue, keeps every candidate
+            /// whose closed neighbourhoods in the original and the lifted graph do not
+            /// meet those of an earlier candidate of the round, and contracts the kept
+            /// edges concurrently; the others go back to the queue. The conflicts are
+            /// found concurrently as well, by reservations of the vertices (see
+            /// runBatched). numberOfThreads == 0 uses all hardware threads.
+            ///
+            /// With deterministic == true, the contractions of a round are numbered and
+            /// committed in queue order, so the labeling depends on batchSize only and
+            /// is the same for every number of threads. With deterministic == false,
+            /// every contraction is committed as soon as its thread finishes; this
+            /// avoids the ordered commit at the end of each round, but the merge count
+            /// in the balancing term, and thereby the labeling, depends on scheduling.
+            ///
+            /// balancedEdgeContraction() and balancedEdgeContraction_cut() first contract
+            /// all original edges whose cost is greater than preContractionThreshold, in
+            /// parallel on preContractionThreads threads (0, the default: all hardware
+            /// threads), and run the greedy contraction on the resulting clusters (see
+            /// detail::preContractedBalancedEdgeContraction). The default threshold,
+            /// infinity, turns this pre-contraction off. preContractionThreads does not
+            /// change the result and is independent of numberOfThreads, so a sequential
+            /// greedy contraction can follow a parallel pre-contraction.
+            ///
+            struct BalancedEdgeContractionSettings
+            {
+                std::size_t numberOfThreads { 1 };
+                std::size_t batchSize { 1024 };
+                bool deterministic { true };
+                double preContractionThreshold { std::numeric_limits<double>::infinity() };
+                std::size_t preContractionThreads { 0 };
+            };
+
+            /// Types of the contraction state of BEC and BEC-cut.
+            ///
+            /// INDEX holds vertex and original edge indices in the contracted graphs,
+            /// the queue and the partition. VALUE holds costs, cluster sizes and
+            /// priorities, and all arithmetic on them is done in VALUE; costs are
+            /// converted to VALUE when they are read.
+            ///
+            template<typename INDEX = std::size_t, typename VALUE = double>
+                struct ContractionPolicy
+                {
+                    typedef INDEX index_type;
+                    typedef VALUE value_type;
+                };
+
+            /// Policy for graphs with fewer than 2^32 vertices and original edges. It
+            /// halves the memory of the contracted graphs and the queue, at the
+            /// precision of float.
+            ///
+            typedef ContractionPolicy<std::uint32_t, float> CompactContractionPolicy;
+
+            namespace detail {
+
+                /// Contraction state shared by BEC and BEC-cut.
+                ///
+                /// RULE defines the priority (RULE::Edge) of a contractible edge, how it is
+                /// initialized and recomputed after a contraction, and any per-cluster
+                /// state it needs (see BEC.hxx and BEC_cut.hxx). POLICY (a ContractionPolicy)
+                /// selects the types of the state. VISITOR receives the callbacks
+                /// described in BEC_visitor.hxx.
+                ///
+                template<typename POLICY, typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename RULE, typename VISITOR>
+                    class BalancedEdgeContraction
+                    {
+                        public:
+                            typedef typename POLICY::value_type value_type;
+                            typedef typename POLICY::index_type index_type;
+                            typedef typename RULE::Edge Edge;
+
+                            BalancedEdgeContraction(
+                                    const ORIGGRAPH& original_graph,
+                                    const LIFTGRAPH& lifted_graph,
+                                    EVA const& edge_values,
+                                    VISITOR& visitor
+                                    ) :
+                                original_graph_(original_graph),
+                                lifted_graph_(lifted_graph),
+                                edge_values_(edge_values),
+                                original_graph_cp_(original_graph.numberOfVertices()),
+                                lifted_graph_cp_(original_graph.numberOfVertices()),
+                                edge_vertices_(original_graph.numberOfEdges()),
+                                Q_(original_graph.numberOfEdges()),
+                                rule_(original_graph.numberOfVertices()),
+                                partition_(original_graph.numberOfVertices()),
+                                numberOfVertices_(original_graph.numberOfVertices()),
+                                nmerges_(0),
+                                visitor_(visitor)
+                        {
+                            initialize(UnitSizes());
+                        }
+
+                            /// Continues a contraction from a clustering of a larger graph.
+                            ///
+                            /// Vertex v of original_graph and lifted_graph stands for a cluster of
+                            /// cluster_sizes[v] vertices of a graph with numberOfVertices vertices,
+                            /// lifted_graph holds the summed costs between clusters. The balancing
+                            /// term counts the merges that formed the clusters, so the result is
+                            /// that of a contraction of the larger graph that had reached them.
+                            ///
+                            template<typename VSA>
+                                BalancedEdgeContraction(
+                                        const ORIGGRAPH& original_graph,
+                                        const LIFTGRAPH& lifted_graph,
+                                        EVA const& edge_values,
+                                        VSA const& cluster_sizes,
+                                        size_t numberOfVertices,
+                                        VISITOR& visitor
+                                        ) :
+                                    original_graph_(original_graph),
+                                    lifted_graph_(lifted_graph),
+                                    edge_values_(edge_values),
+                                    original_graph_cp_(original_graph.numberOfVertices()),
+                                    lifted_graph_cp_(original_graph.numberOfVertices()),
+                                    edge_vertices_(original_graph.numberOfEdges()),
+                                    Q_(original_graph.numberOfEdges()),
+                                    rule_(original_graph.numberOfVertices()),
+                                    partition_(original_graph.numberOfVertices()),
+                                    numberOfVertices_(numberOfVertices),
+                                    nmerges_(numberOfVertices - original_graph.numberOfVertices()),
+                                    visitor_(visitor)
+                        {
+                            initialize(cluster_sizes);
+                        }
+
+                            void run(BalancedEdgeContractionSettings const& settings)
+                            {
+                                visitor_.beginPhase(BalancedEdgeContractionPhase::Contraction);
+
+                                if (settings.numberOfThreads == 1)
+                                    runSequential();
+                                else
+                                    runBatched(settings);
+
+                                visitor_.endPhase(BalancedEdgeContractionPhase::Contraction);
+                                visitor_.terminated(nmerges_, Q_.size());
+                            }
+
+                            template<typename ELA>
+                                void labelEdges(ELA& edge_labels)
+                                {
+                                    visitor_.beginPhase(BalancedEdgeContractionPhase::Labeling);
+
+                                    for (size_t i = 0; i < lifted_graph_.numberOfEdges(); ++i)
+                                        edge_labels[i] = partition_.find(lifted_graph_.vertexOfEdge(i, 0)) == partition_.find(lifted_graph_.vertexOfEdge(i, 1)) ? 0 : 1;
+
+                                    visitor_.endPhase(BalancedEdgeContractionPhase::Labeling);
+                                }
+
+                            /// Writes to vertex_labels[v] a vertex of the cluster of v, the same for all its vertices.
+                            template<typename VLA>
+                                void labelVertices(VLA& vertex_labels)
+                                {
+                                    for (size_t v = 0; v < original_graph_.numberOfVertices(); ++v)
+                                        vertex_labels[v] = partition_.find(v);
+                                }
+
+                            /// Returns the vertex that stands for the cluster of v in the contracted graphs.
+                            size_t clusterOf(size_t v)
+                            {
+                                return partition_.find(v);
+                            }
+
+                            /// Contracts the clusters of the endpoints of the original edge {a, b},
+                            /// whatever its priority. Used to start from a given partition.
+                            void join(size_t a, size_t b)
+                            {
+                                auto const ra = partition_.find(a);
+                                auto const rb = partition_.find(b);
+                                if (ra == rb)
+                                    return;
+
+                                auto const key = *original_graph_cp_.findEdge(ra, rb);
+                                auto const edge = Q_.contains(key) ? Q_.value(key) : Edge();
+                                Q_.erase(key);
+
+                                ++nmerges_;
+                                commit(contract(ra, rb, edge, nmerges_, Q_), edge);
+                            }
+
+                            /// Splits the clusters of the given vertices into singletons, as if they had
+                            /// never been contracted, with the current edge values, which may have
+                            /// changed since the construction. The cost is linear in the number of
+                            /// edges incident to these clusters. run() then contracts on from there.
+                            ///
+                            void dissolve(std::vector<size_t> const& vertices, VertexIncidence<index_type> const& original_incidence, VertexIncidence<index_type> const& lifted_incidence)
+                            {
+                                visitor_.beginPhase(BalancedEdgeContractionPhase::GraphCopy);
+
+                                stamps_.resize(original_graph_cp_.numberOfVertices(), 0);
+                                auto const round = ++round_;
+
+                                std::vector<size_t> members;
+                                for (auto v : vertices)
+                                {
+                                    auto const root = partition_.find(v);
+                                    if (stamps_[root] == round)
+                                        continue;
+
+                                    size_t size = 0;
+                                    partition_.forEachMember(root, [&](size_t u)
+                                            {
+                                            stamps_[u] = round;
+                                            members.push_back(u);
+                                            ++size;
+                                            });
+
+                                    for (auto const& p : original_graph_cp_.getAdjacentVertices(root))
+                                        Q_.erase(p.second);
+
+                                    original_graph_cp_.removeVertex(root);
+                                    lifted_graph_cp_.removeVertex(root);
+                                    nmerges_ -= size - 1;
+                                }
+
+                                for (auto u : members)
+                                {
+                                    partition_.isolate(u);
+                                    lifted_graph_cp_.setVertexWeights(u, value_type(1));
+                                }
+
+                                for (auto u : members)
+                                {
+                                    for (auto e = original_incidence.begin(u); e != original_incidence.end(u); ++e)
+                                    {
+                                        auto const w = partition_.find(original_graph_.vertexOfEdge(*e, 0) == u ? original_graph_.vertexOfEdge(*e, 1) : original_graph_.vertexOfEdge(*e, 0));
+                                        if (w == u || original_graph_cp_.edgeExists(u, w))
+                                            continue;
+
+                                        original_graph_cp_.setEdgeWeight(u, w, *e);
+                                        edge_vertices_[*e] = orderedPair(u, w);
+                                    }
+
+                                    auto incident = value_type();
+                                    for (auto e = lifted_incidence.begin(u); e != lifted_incidence.end(u); ++e)
+                                    {
+                                        auto const other = lifted_graph_.vertexOfEdge(*e, 0) == u ? lifted_graph_.vertexOfEdge(*e, 1) : lifted_graph_.vertexOfEdge(*e, 0);
+                                        if (other == u)
+                                            continue;
+
+                                        auto const cost = static_cast<value_type>(edge_values_[*e]);
+                                        incident += cost;
+
+                                        // an edge between two members is added once, from its smaller endpoint
+                                        if (stamps_[other] == round && other < u)
+                                            continue;
+
+                                        auto const w = partition_.find(other);
+                                        auto const c = lifted_graph_cp_.findEdge(u, w);
+                                        lifted_graph_cp_.setEdgeWeight(u, w, cost + (c != nullptr ? *c : value_type()));
+                                    }
+
+                                    rule_.reset(u, incident);
+                                }
+
+                                visitor_.endPhase(BalancedEdgeContractionPhase::GraphCopy);
+                                visitor_.beginPhase(BalancedEdgeContractionPhase::QueueBuild);
+
+                                for (auto u : members)
+                                    for (auto const& p : lifted_graph_cp_.getAdjacentVertices(u))
+                                    {
+                                        auto const key = original_graph_cp_.findEdge(u, p.first);
+                                        if (key != nullptr)
+                                            Q_.push(*key, startPriority(u, p.first, p.second));
+                                    }
+
+                                visitor_.endPhase(BalancedEdgeContractionPhase::QueueBuild);
+                            }
+
+                        private:
+                            struct UnitSizes
+                            {
+                                value_type operator[](size_t) const
+                                {
+                                    return value_type(1);
+                                }
+                            };
+
+                            template<typename VSA>
+                                void initialize(VSA const& cluster_sizes)
+                                {
+                                    auto const& original_graph = original_graph_;
+                                    auto const& lifted_graph = lifted_graph_;
+                                    auto const& edge_values = edge_values_;
+
+                                    if (original_graph.numberOfVertices() >= static_cast<std::size_t>(std::numeric_limits<index_type>::max())
+                                            || original_graph.numberOfEdges() >= static_cast<std::size_t>(std::numeric_limits<index_type>::max()))
+                                        throw std::runtime_error("the index type of the contraction policy is too small for this graph");
+
+                                    visitor_.beginPhase(BalancedEdgeContractionPhase::GraphCopy);
+
+                                    // the weight of an edge of original_graph_cp_ is its key in Q_,
+                                    // edge_vertices_ holds the endpoints of each key (smaller vertex first)
+                                    for (size_t i = 0; i < original_graph.numberOfEdges(); ++i)
+                                    {
+                                        auto a = original_graph.vertexOfEdge(i, 0);
+                                        auto b = original_graph.vertexOfEdge(i, 1);
+
+                                        if (original_graph_cp_.edgeExists(a, b))
+                                            continue;
+
+                                        original_graph_cp_.setEdgeWeight(a, b, i);
+                                        edge_vertices_[i] = orderedPair(a, b);
+                                    }
+
+                                    for (size_t i = 0; i < lifted_graph.numberOfVertices(); ++i)
+                                        lifted_graph_cp_.setVertexWeights(i, cluster_sizes[i]);
+
+                                    for (size_t i = 0; i < lifted_graph.numberOfEdges(); ++i)
+                                    {
+                                        auto a = lifted_graph.vertexOfEdge(i, 0);
+                                        auto b = lifted_graph.vertexOfEdge(i, 1);
+
+                                        auto const cost = static_cast<value_type>(edge_values[i]);
+                                        lifted_graph_cp_.setEdgeWeight(a, b, cost);
+                                        rule_.addCost(a, b, cost);
+                                    }
+
+                                    visitor_.endPhase(BalancedEdgeContractionPhase::GraphCopy);
+                                    visitor_.beginPhase(BalancedEdgeContractionPhase::QueueBuild);
+
+                                    for (size_t i = 0; i < lifted_graph.numberOfEdges(); ++i)
+                                    {
+                                        auto a = lifted_graph.vertexOfEdge(i, 0);
+                                        auto b = lifted_graph.vertexOfEdge(i, 1);
+
+                                        auto const key = original_graph_cp_.findEdge(a, b);
+                                        if (key != nullptr)
+                                            Q_.push(*key, startPriority(a, b, *lifted_graph_cp_.findEdge(a, b)));
+                                    }
+
+                                    visitor_.endPhase(BalancedEdgeContractionPhase::QueueBuild);
+                                    visitor_.initialized(original_graph.numberOfVertices(), Q_.size());
+                                }
+
+                            /// Priority of the edge {a, b} of cost c between two clusters that were not
+                            /// formed by contract(): the initial one before the first merge, afterwards
+                            /// balanced as in contract().
+                            Edge startPriority(size_t a, size_t b, value_type c) const
+                            {
+                                if (nmerges_ == 0)
+                                    return rule_.initialPriority(a, b, c);
+
+                                auto const balance = static_cast<value_type>(numberOfVertices_) / static_cast<value_type>(nmerges_);
+                                value_type wn = (lifted_graph_cp_.returnVertexWeights(a) + lifted_graph_cp_.returnVertexWeights(b))/balance;
+                                return rule_.priority(a, b, c, wn);
+                            }
+
+                            static std::pair<index_type, index_type> orderedPair(size_t a, size_t b)
+                            {
+                                return std::make_pair(static_cast<index_type>(std::min(a, b)), static_cast<index_type>(std::max(a, b)));
+                            }
+
+                            /// Queue operations of one contraction, recorded while other contractions run.
+                            class QueueUpdates
+                            {
+                                public:
+                                    void push(size_t key, Edge const& edge)
+                                    {
+                                        updates_.push_back(Update(key, edge, false));
+                                    }
+
+                                    void erase(size_t key)
+                                    {
+                                        updates_.push_back(Update(key, Edge(), true));
+                                    }
+
+                                    void clear()
+                                    {
+                                        updates_.clear();
+                                    }
+
+                                    template<typename QUEUE>
+                                        void apply(QUEUE& Q) const
+                                        {
+                                            for (auto const& u : updates_)
+                                                if (u.erase)
+                                                    Q.erase(u.key);
+                                                else
+                                                    Q.push(u.key, u.edge);
+                                        }
+
+                                private:
+                                    struct Update
+                                    {
+                                        Update(size_t _key, Edge const& _edge, bool _erase) :
+                                            key(_key),
+                                            edge(_edge),
+                                            erase(_erase)
+                                        {}
+
+                                        size_t key;
+                                        Edge edge;
+                                        bool erase;
+                                    };
+
+                                    std::vector<Update> updates_;
+                            };
+
+                            struct Contraction
+                            {
+                                size_t stable_vertex;
+                                size_t merge_vertex;
+                                value_type stable_size;
+                                value_type merge_size;
+                            };
+
+                            void commit(Contraction const& contraction, Edge const& edge)
+                            {
+                                partition_.merge(contraction.stable_vertex, contraction.merge_vertex);
+                                visitor_.merged(edge.w, contraction.stable_size, contraction.merge_size);
+                            }
+
+                            struct Candidate
+                            {
+                                Candidate(size_t _key, Edge const& _edge) :
+                                    key(_key),
+                                    edge(_edge)
+                                {}
+
+                                size_t key;
+                                Edge edge;
+                            };
+
+                            void runSequential()
+                            {
+                                while (!Q_.empty())
+                                {
+                                    if (Q_.top().w < value_type())
+                                        break;
+
+                                    auto const edge = Q_.top();
+                                    auto const vertices = edge_vertices_[Q_.topKey()];
+                                    Q_.pop();
+
+                                    ++nmerges_;
+
+                                    commit(contract(vertices.first, vertices.second, edge, nmerges_, Q_), edge);
+                                }
+                            }
+
+                            /// Batched contraction. A round pops up to batchSize candidates and runs
+                            /// three parallel steps:
+                            ///
+                            /// 1. Every candidate raises the reservation of each vertex of its closed
+                            ///    neighbourhoods to its ticket. Tickets grow with every round, also
+                            ///    across runs, and within a round are larger for earlier candidates.
+                            /// 2. A candidate is kept if it holds the reservation of all these vertices,
+                            ///    i.e. if no earlier candidate of the round meets its neighbourhoods.
+                            ///    The first candidate is always kept.
+                            /// 3. The kept candidates are contracted.
+                            ///
+                            /// Where the top of the queue is dense with conflicts, most candidates
+                            /// would be walked for nothing, so the number of candidates per round is
+                            /// halved whenever fewer than half of them are kept, and doubled, up to
+                            /// batchSize, whenever at least three quarters are kept.
+                            ///
+                            /// The kept candidates do not depend on the number of threads. Only the
+                            /// queue operations and the partition are updated serially.
+                            ///
+                            /// The reservations and the thread pool are kept for the next run (e.g.
+                            /// of the incremental solvers), which therefore neither allocates nor
+                            /// clears O(numberOfVertices) memory nor starts threads, unless
+                            /// numberOfThreads changes.
+                            ///
+                            void runBatched(BalancedEdgeContractionSettings const& settings)
+                            {
+                                if (!pool_ || pool_threads_ != settings.numberOfThreads)
+                                {
+                                    pool_.reset();
+                                    pool_.reset(new ThreadPool(settings.numberOfThreads));
+                                    pool_threads_ = settings.numberOfThreads;
+                                }
+                                auto& pool = *pool_;
+
+                                // the vertices of the contracted graph never change, so the
+                                // reservations are allocated once; stale tickets are smaller than
+                                // those of any later round
+                                if (reservations_.size() != original_graph_cp_.numberOfVertices())
+                                {
+                                    std::vector<std::atomic<size_t>>(original_graph_cp_.numberOfVertices()).swap(reservations_);
+                                    for (auto& r : reservations_)
+                                        r.store(0, std::memory_order_relaxed);
+                                }
+                                auto& reservations = reservations_;
+
+                                auto const batch_size = std::max<size_t>(1, settings.batchSize);
+                                std::vector<Candidate> batch;
+                                std::vector<char> kept(batch_size);
+                                std::vector<size_t> order(batch_size);
+                                std::vector<Contraction> merged(batch_size);
+                                std::vector<QueueUpdates> updates(settings.deterministic ? batch_size : pool.numberOfThreads());
+                                std::mutex commit_mutex;
+                                size_t candidates = batch_size;
+
+                                for (;;)
+                                {
+                                    batch.clear();
+                                    while (!Q_.empty() && batch.size() < candidates && !(Q_.top().w < value_type()))
+                                    {
+                                        batch.push_back(Candidate(Q_.topKey(), Q_.top()));
+                                        Q_.pop();
+                                    }
+
+                                    if (batch.empty())
+                                        break;
+
+                                    auto const first_ticket = tickets_;
+                                    tickets_ += batch_size;
+                                    auto ticket = [&](size_t i) { return first_ticket + (batch_size - 1 - i); };
+
+                                    pool.parallelFor(batch.size(), [&](size_t, size_t i)
+                                            {
+                                            auto const t = ticket(i);
+                                            forEachNeighbourhoodVertex(edge_vertices_[batch[i].key], [&](size_t v)
+                                                    {
+                                                    auto r = reservations[v].load(std::memory_order_relaxed);
+                                                    while (r < t && !reservations[v].compare_exchange_weak(r, t, std::memory_order_relaxed))
+                                                    {}
+                                                    return true;
+                                                    });
+                                            });
+
+                                    pool.parallelFor(batch.size(), [&](size_t, size_t i)
+                                            {
+                                            auto const t = ticket(i);
+                                            kept[i] = forEachNeighbourhoodVertex(edge_vertices_[batch[i].key], [&](size_t v)
+                                                    {
+                                                    return reservations[v].load(std::memory_order_relaxed) == t;
+                                                    });
+                                            });
+
+                                    // the queue and the edge vertices are changed by the contractions only
+                                    // after the candidates that were not kept are back in the queue
+                                    size_t numberOfKept = 0;
+                                    for (size_t i = 0; i < batch.size(); ++i)
+                                        if (kept[i])
+                                            order[i] = numberOfKept++;
+                                        else
+                                        {
+                                            visitor_.skipped(batch[i].edge.w);
+                                            Q_.push(batch[i].key, batch[i].edge);
+                                        }
+
+                                    if (2 * numberOfKept < batch.size())
+                                        candidates = std::max<size_t>(1, candidates / 2);
+                                    else if (4 * numberOfKept >= 3 * batch.size())
+                                        candidates = std::min(batch_size, 2 * candidates);
+
+                                    if (settings.deterministic)
+                                    {
+                                        auto const nmerges = nmerges_;
+                                        pool.parallelFor(batch.size(), [&](size_t, size_t i)
+                                                {
+                                                if (!kept[i])
+                                                    return;
+                                                updates[i].clear();
+                                                auto const vertices = edge_vertices_[batch[i].key];
+                                                merged[i] = contract(vertices.first, vertices.second, batch[i].edge, nmerges + order[i] + 1, updates[i]);
+                                                });
+
+                                        for (size_t i = 0; i < batch.size(); ++i)
+                                            if (kept[i])
+                                            {
+                                                commit(merged[i], batch[i].edge);
+                                                updates[i].apply(Q_);
+                                            }
+
+                                        nmerges_ += numberOfKept;
+                                    }
+                                    else
+                                    {
+                                        std::atomic<size_t> nmerges(nmerges_);
+                                        pool.parallelFor(batch.size(), [&](size_t thread, size_t i)
+                                                {
+                                                if (!kept[i])
+                                                    return;
+                                                updates[thread].clear();
+                                                auto const vertices = edge_vertices_[batch[i].key];
+                                                auto const contraction = contract(vertices.first, vertices.second, batch[i].edge, ++nmerges, updates[thread]);
+
+                                                std::lock_guard<std::mutex> lock(commit_mutex);
+                                                commit(contraction, batch[i].edge);
+                                                updates[thread].apply(Q_);
+                                                });
+
+                                        nmerges_ = nmerges;
+                                    }
+                                }
+                            }
+
+                            /// Calls f(v) for every vertex v of the closed neighbourhoods of both endpoints,
+                            /// in the original and the lifted graph, until f returns false. Returns
+                            /// whether f never did.
+                            template<typename F>
+                                bool forEachNeighbourhoodVertex(std::pair<index_type, index_type> const& vertices, F f) const
+                                {
+                                    size_t const endpoints[] = { vertices.first, vertices.second };
+
+                                    for (auto v : endpoints)
+                                    {
+                                        if (!f(v))
+                                            return false;
+                                        for (auto const& p : original_graph_cp_.getAdjacentVertices(v))
+                                            if (!f(p.first))
+                                                return false;
+                                        for (auto const& p : lifted_graph_cp_.getAdjacentVertices(v))
+                                            if (!f(p.first))
+                                                return false;
+                                    }
+
+                                    return true;
+                                }
+
+                            /// Contracts the edge {a, b} and hands the resulting changes of priorities to Q.
+                            ///
+                            /// Only the two endpoints and their neighbours are read or written, so
+                            /// contractions with disjoint closed neighbourhoods can run concurrently.
+                            /// Returns the stable and the merged vertex and the sizes of their clusters.
+                            ///
+                            template<typename QUEUE>
+                                Contraction contract(size_t a, size_t b, Edge const& edge, size_t nmerges, QUEUE& Q)
+                                {
+                                    auto stable_vertex = a;
+                                    auto merge_vertex = b;
+
+                                    if (lifted_graph_cp_.getAdjacentVertices(stable_vertex).size() < lifted_graph_cp_.getAdjacentVertices(merge_vertex).size())
+                                        std::swap(stable_vertex, merge_vertex);
+
+                                    for (auto& p : original_graph_cp_.getAdjacentVertices(merge_vertex))
+                                    {
+                                        if (p.first == stable_vertex)
+                                            continue;
+
+                                        // every edge of merge_vertex gets a new priority below, or none at all
+                                        Q.erase(p.second);
+
+                                        if (original_graph_cp_.edgeExists(stable_vertex, p.first))
+                                            continue;
+
+                                        original_graph_cp_.setEdgeWeight(stable_vertex, p.first, p.second);
+                                        edge_vertices_[p.second] = orderedPair(stable_vertex, p.first);
+                                    }
+
+                                    original_graph_cp_.removeVertex(merge_vertex);
+
+                                    rule_.merge(stable_vertex, merge_vertex, edge);
+
+                                    auto const nwa = lifted_graph_cp_.returnVertexWeights(stable_vertex);
+                                    auto const nwb = lifted_graph_cp_.returnVertexWeights(merge_vertex);
+                                    lifted_graph_cp_.setVertexWeights(stable_vertex, nwa + nwb);
+
+                                    auto const balance = static_cast<value_type>(numberOfVertices_) / static_cast<value_type>(nmerges);
+
+                                    for (auto& p : lifted_graph_cp_.getAdjacentVertices(stable_vertex))
+                                    {
+                                        if (p.first == merge_vertex)
+                                            continue;
+
+                                        auto const key = original_graph_cp_.findEdge(stable_vertex, p.first);
+                                        if (key == nullptr)
+                                            continue;
+
+                                        if (lifted_graph_cp_.edgeExists(merge_vertex, p.first))
+                                            continue;
+
+                                        auto const nwp = lifted_graph_cp_.returnVertexWeights(p.first);
+
+                                        value_type wn = (nwa+nwb+nwp)/balance;
+                                        Q.push(*key, rule_.priority(stable_vertex, p.first, p.second, wn));
+                                    }
+
+                                    for (auto& p : lifted_graph_cp_.getAdjacentVertices(merge_vertex))
+                                    {
+                                        if (p.first == stable_vertex)
+                                            continue;
+
+                                        auto const nwp = lifted_graph_cp_.returnVertexWeights(p.first);
+
+                                        auto tp = value_type();
+                                        auto const w_sp = lifted_graph_cp_.findEdge(stable_vertex, p.first);
+                                        if (w_sp != nullptr)
+                                            tp = *w_sp;
+
+                                        lifted_graph_cp_.setEdgeWeight(stable_vertex, p.first, p.second + tp);
+
+                                        value_type wn = (nwa+nwb+nwp)/balance;
+                                        auto const key = original_graph_cp_.findEdge(stable_vertex, p.first);
+                                        if (key != nullptr)
+                                            Q.push(*key, rule_.priority(stable_vertex, p.first, p.second + tp, wn));
+                                    }
+
+                                    lifted_graph_cp_.removeVertex(merge_vertex);
+
+                                    Contraction contraction = { stable_vertex, merge_vertex, nwa, nwb };
+                                    return contraction;
+                                }
+
+                            const ORIGGRAPH& original_graph_;
+                            const LIFTGRAPH& lifted_graph_;
+                            EVA const& edge_values_;
+                            ContractionGraph<index_type, index_type> original_graph_cp_;
+                            ContractionGraph<value_type, index_type> lifted_graph_cp_;
+                            std::vector<std::pair<index_type, index_type>> edge_vertices_;
+                            IndexedPriorityQueue<Edge, std::less<Edge>, 4, index_type> Q_;
+                            RULE rule_;
+                            ContractionPartition<index_type> partition_;
+                            size_t numberOfVertices_;
+                            size_t nmerges_;
+                            VISITOR& visitor_;
+                            std::vector<index_type> stamps_;    // marks of dissolve()
+                            index_type round_ { 0 };
+                            std::unique_ptr<ThreadPool> pool_;  // of runBatched(), with pool_threads_ threads requested
+                            size_t pool_threads_ { 0 };
+                            std::vector<std::atomic<size_t>> reservations_;
+                            size_t tickets_ { 1 };              // first ticket of the next round of runBatched()
+                    };
+
+            } // namespace detail
+
+        } // namespace multicut_lifted
+    } // namespace graph
+} // namespace andres
+
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_CORE_HXX
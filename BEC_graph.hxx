@@ -0,0 +1,401 @@
+#pragma once
+#ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_GRAPH_HXX
+#define ANDRES_GRAPH_MULTICUT_LIFTED_BEC_GRAPH_HXX
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace andres {
+    namespace graph {
+        namespace multicut_lifted {
+
+            /// Weighted graph whose vertices can be contracted. (used by BEC and BEC-cut)
+            ///
+            /// The neighbourhood of every vertex is a flat open-addressing hash table
+            /// (linear probing, backward-shift deletion) held in one contiguous array,
+            /// so that lookups and updates touch one or two cache lines instead of
+            /// walking the nodes of a red-black tree. The table of a removed vertex is
+            /// released immediately. Vertices are stored as INDEX, so a 32-bit INDEX
+            /// halves the size of the tables when there are fewer than 2^32 vertices.
+            ///
+            template<typename VALUE_TYPE, typename INDEX = std::size_t>
+                class ContractionGraph
+                {
+                    public:
+                        typedef VALUE_TYPE value_type;
+                        typedef INDEX index_type;
+                        typedef std::pair<index_type, value_type> AdjacentVertex;
+
+                        class AdjacentVertexIterator
+                        {
+                            public:
+                                typedef std::forward_iterator_tag iterator_category;
+                                typedef AdjacentVertex value_type;
+                                typedef std::ptrdiff_t difference_type;
+                                typedef AdjacentVertex const* pointer;
+                                typedef AdjacentVertex const& reference;
+
+                                AdjacentVertexIterator(pointer position, pointer end) :
+                                    position_(position),
+                                    end_(end)
+                            {
+                                skipEmpty();
+                            }
+
+                                reference operator*() const
+                                {
+                                    return *position_;
+                                }
+
+                                pointer operator->() const
+                                {
+                                    return position_;
+                                }
+
+                                AdjacentVertexIterator& operator++()
+                                {
+                                    ++position_;
+                                    skipEmpty();
+                                    return *this;
+                                }
+
+                                AdjacentVertexIterator operator++(int)
+                                {
+                                    AdjacentVertexIterator it = *this;
+                                    ++*this;
+                                    return it;
+                                }
+
+                                bool operator==(AdjacentVertexIterator const& other) const
+                                {
+                                    return position_ == other.position_;
+                                }
+
+                                bool operator!=(AdjacentVertexIterator const& other) const
+                                {
+                                    return position_ != other.position_;
+                                }
+
+                            private:
+                                void skipEmpty()
+                                {
+                                    while (position_ != end_ && position_->first == emptyKey())
+                                        ++position_;
+                                }
+
+                                pointer position_;
+                                pointer end_;
+                        };
+
+                        class AdjacentVertices
+                        {
+                            public:
+                                AdjacentVertices(AdjacentVertex const* begin, AdjacentVertex const* end, std::size_t size) :
+                                    begin_(begin),
+                                    end_(end),
+                                    size_(size)
+                            {}
+
+                                AdjacentVertexIterator begin() const
+                                {
+                                    return AdjacentVertexIterator(begin_, end_);
+                                }
+
+                                AdjacentVertexIterator end() const
+                                {
+                                    return AdjacentVertexIterator(end_, end_);
+                                }
+
+                                std::size_t size() const
+                                {
+                                    return size_;
+                                }
+
+                                bool empty() const
+                                {
+                                    return size_ == 0;
+                                }
+
+                            private:
+                                AdjacentVertex const* begin_;
+                                AdjacentVertex const* end_;
+                                std::size_t size_;
+                        };
+
+                        ContractionGraph(std::size_t n) :
+                            tables_(n),
+                            sizes_(n),
+                            vertex_weights_(n)
+                    {}
+
+                        std::size_t numberOfVertices() const
+                        {
+                            return tables_.size();
+                        }
+
+                        bool edgeExists(std::size_t a, std::size_t b) const
+                        {
+                            return findEdge(a, b) != nullptr;
+                        }
+
+                        /// Returns a pointer to the weight of the edge {a, b}, or nullptr if there is no such edge.
+                        value_type const* findEdge(std::size_t a, std::size_t b) const
+                        {
+                            auto const& table = tables_[a];
+                            if (table.empty())
+                                return nullptr;
+
+                            auto const key = static_cast<index_type>(b);
+                            auto const mask = table.size() - 1;
+                            for (auto i = home(key, mask); ; i = (i + 1) & mask)
+                            {
+                                if (table[i].first == key)
+                                    return &table[i].second;
+                                if (table[i].first == emptyKey())
+                                    return nullptr;
+                            }
+                        }
+
+                        AdjacentVertices getAdjacentVertices(std::size_t v) const
+                        {
+                            auto const& table = tables_[v];
+                            return AdjacentVertices(table.data(), table.data() + table.size(), sizes_[v]);
+                        }
+
+                        std::size_t numberOfAdjacentVertices(std::size_t v) const
+                        {
+                            return sizes_[v];
+                        }
+
+                        value_type getEdgeWeight(std::size_t a, std::size_t b) const
+                        {
+                            auto w = findEdge(a, b);
+                            assert(w != nullptr);
+                            return *w;
+                        }
+
+                        void removeVertex(std::size_t v)
+                        {
+                            for (auto& p : getAdjacentVertices(v))
+                                erase(p.first, v);
+
+                            std::vector<AdjacentVertex>().swap(tables_[v]);
+                            sizes_[v] = 0;
+                        }
+
+                        void setEdgeWeight(std::size_t a, std::size_t b, value_type w)
+                        {
+                            insert(a, b, w);
+                            insert(b, a, w);
+                        }
+
+                        void setVertexWeights(std::size_t a, value_type w)
+                        {
+                            vertex_weights_[a] = w;
+                        }
+
+                        value_type returnVertexWeights(std::size_t a) const
+                        {
+                            return vertex_weights_[a];
+                        }
+
+                    private:
+                        static index_type emptyKey()
+                        {
+                            return std::numeric_limits<index_type>::max();
+                        }
+
+                        static std::size_t home(std::size_t key, std::size_t mask)
+                        {
+                            // Fibonacci hashing: vertex indices of image grids are far from random
+                            std::uint64_t h = static_cast<std::uint64_t>(key) * UINT64_C(0x9E3779B97F4A7C15);
+                            return static_cast<std::size_t>(h ^ (h >> 32)) & mask;
+                        }
+
+                        void insert(std::size_t a, std::size_t b, value_type w)
+                        {
+                            auto& table = tables_[a];
+                            if ((sizes_[a] + 1) * 4 > table.size() * 3)
+                                grow(a);
+
+                            auto const key = static_cast<index_type>(b);
+                            auto const mask = table.size() - 1;
+                            auto i = home(key, mask);
+                            for (; table[i].first != emptyKey(); i = (i + 1) & mask)
+                                if (table[i].first == key)
+                                {
+                                    table[i].second = w;
+                                    return;
+                                }
+
+                            table[i] = AdjacentVertex(key, w);
+                            ++sizes_[a];
+                        }
+
+                        void erase(std::size_t a, std::size_t b)
+                        {
+                            auto& table = tables_[a];
+                            if (table.empty())
+                                return;
+
+                            auto const key = static_cast<index_type>(b);
+                            auto const mask = table.size() - 1;
+                            auto i = home(key, mask);
+                            for (; table[i].first != key; i = (i + 1) & mask)
+                                if (table[i].first == emptyKey())
+                                    return;
+
+                            // shift following entries back into the hole so that no tombstones are needed
+                            for (auto j = (i + 1) & mask; table[j].first != emptyKey(); j = (j + 1) & mask)
+                            {
+                                auto const k = home(table[j].first, mask);
+                                if (((j - k) & mask) >= ((j - i) & mask))
+                                {
+                                    table[i] = table[j];
+                                    i = j;
+                                }
+                            }
+
+                            table[i].first = emptyKey();
+                            --sizes_[a];
+                        }
+
+                        void grow(std::size_t a)
+                        {
+                            std::vector<AdjacentVertex> table(tables_[a].empty() ? 4 : 2 * tables_[a].size(), AdjacentVertex(emptyKey(), value_type()));
+                            table.swap(tables_[a]);
+
+                            auto const mask = tables_[a].size() - 1;
+                            for (auto const& p : table)
+                                if (p.first != emptyKey())
+                                {
+                                    auto i = home(p.first, mask);
+                                    while (tables_[a][i].first != emptyKey())
+                                        i = (i + 1) & mask;
+                                    tables_[a][i] = p;
+                                }
+                        }
+
+                        std::vector<std::vector<AdjacentVertex>> tables_;
+                        std::vector<index_type> sizes_;
+                        std::vector<value_type> vertex_weights_;
+                };
+
+            namespace detail {
+
+                /// Graph given by a list of edges. (used for the tiles and the cluster graphs
+                /// of the tiled mode and the pre-contraction)
+                class TileGraph
+                {
+                    public:
+                        TileGraph(std::size_t numberOfVertices = 0) :
+                            numberOfVertices_(numberOfVertices)
+                    {}
+
+                        std::size_t numberOfVertices() const
+                        {
+                            return numberOfVertices_;
+                        }
+
+                        std::size_t numberOfEdges() const
+                        {
+                            return vertices_.size() / 2;
+                        }
+
+                        std::size_t vertexOfEdge(std::size_t e, std::size_t j) const
+                        {
+                            return vertices_[2 * e + j];
+                        }
+
+                        void reserve(std::size_t numberOfEdges)
+                        {
+                            vertices_.reserve(2 * numberOfEdges);
+                        }
+
+                        void insertEdge(std::size_t a, std::size_t b)
+                        {
+                            vertices_.push_back(a);
+                            vertices_.push_back(b);
+                        }
+
+                        /// Sets the number of edges; edges are then written by setEdge, which
+                        /// different threads may call for different edges.
+                        void resize(std::size_t numberOfEdges)
+                        {
+                            vertices_.resize(2 * numberOfEdges);
+                        }
+
+                        void setEdge(std::size_t e, std::size_t a, std::size_t b)
+                        {
+                            vertices_[2 * e] = a;
+                            vertices_[2 * e + 1] = b;
+                        }
+
+                    private:
+                        std::size_t numberOfVertices_;
+                        std::vector<std::size_t> vertices_;
+                };
+
+            } // namespace detail
+
+            /// Edges incident to every vertex of a graph, in CSR form. (used by the incremental BEC and BEC-cut)
+            ///
+            /// Edges are stored as INDEX, which must be able to hold every edge index of
+            /// the graph; a 32-bit INDEX halves the size of the lists.
+            ///
+            template<typename INDEX = std::size_t>
+                class VertexIncidence
+                {
+                    public:
+                        typedef INDEX index_type;
+
+                        template<typename GRAPH>
+                            VertexIncidence(GRAPH const& graph) :
+                                offsets_(graph.numberOfVertices() + 1, 0),
+                                edges_(2 * graph.numberOfEdges())
+                            {
+                                if (graph.numberOfEdges() > static_cast<std::size_t>(std::numeric_limits<index_type>::max()))
+                                    throw std::runtime_error("the index type of the vertex incidence is too small for this graph");
+
+                                for (std::size_t e = 0; e < graph.numberOfEdges(); ++e)
+                                {
+                                    ++offsets_[graph.vertexOfEdge(e, 0) + 1];
+                                    ++offsets_[graph.vertexOfEdge(e, 1) + 1];
+                                }
+                                for (std::size_t v = 0; v < graph.numberOfVertices(); ++v)
+                                    offsets_[v + 1] += offsets_[v];
+
+                                std::vector<std::size_t> next(offsets_.begin(), offsets_.end() - 1);
+                                for (std::size_t e = 0; e < graph.numberOfEdges(); ++e)
+                                {
+                                    edges_[next[graph.vertexOfEdge(e, 0)]++] = static_cast<index_type>(e);
+                                    edges_[next[graph.vertexOfEdge(e, 1)]++] = static_cast<index_type>(e);
+                                }
+                            }
+
+                        index_type const* begin(std::size_t v) const
+                        {
+                            return edges_.data() + offsets_[v];
+                        }
+
+                        index_type const* end(std::size_t v) const
+                        {
+                            return edges_.data() + offsets_[v + 1];
+                        }
+
+                    private:
+                        std::vector<std::size_t> offsets_;
+                        std::vector<index_type> edges_;
+                };
+
+        } // namespace multicut_lifted
+    } // namespace graph
+} // namespace andres
+
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_GRAPH_HXX
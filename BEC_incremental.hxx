@@ -0,0 +1,175 @@
+#pragma once
+#ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_INCREMENTAL_HXX
+#define ANDRES_GRAPH_MULTICUT_LIFTED_BEC_INCREMENTAL_HXX
+
+#include <cstddef>
+#include <vector>
+
+#include "andres/graph/multicut-lifted/BEC_core.hxx"
+#include "andres/graph/multicut-lifted/BEC_graph.hxx"
+#include "andres/graph/multicut-lifted/BEC_visitor.hxx"
+
+namespace andres {
+    namespace graph {
+        namespace multicut_lifted {
+
+            namespace detail {
+
+                /// BEC or BEC-cut (RULE) that keeps its contraction state between solves.
+                ///
+                /// The constructor solves the instance, from singletons or from a given
+                /// partition. After that, setEdgeValue() changes lifted edge costs and
+                /// run() solves again: only the clusters that contain an endpoint of a
+                /// changed edge are split into singletons, and the greedy contraction
+                /// resumes from the remaining clusters. The cost of run() grows with the
+                /// size of these clusters and the merges that follow, not with the size
+                /// of the graphs. The result is that of a contraction that had reached
+                /// the remaining clusters, so it may differ from a solve from scratch.
+                ///
+                /// The graphs must outlive the object; the costs are copied. The
+                /// structure of the graphs is fixed, a removed lifted edge is one of cost 0.
+                /// The costs are held as the value type of POLICY (a ContractionPolicy), and
+                /// the incidence lists of the graphs as its index type.
+                /// The object can be neither copied nor moved, as the contraction refers to
+                /// the costs and the visitor held by it.
+                ///
+                template<typename POLICY, typename ORIGGRAPH, typename LIFTGRAPH, typename RULE, typename VISITOR>
+                    class IncrementalBalancedEdgeContraction
+                    {
+                        public:
+                            typedef typename POLICY::value_type value_type;
+
+                            template<typename EVA>
+                                IncrementalBalancedEdgeContraction(
+                                        const ORIGGRAPH& original_graph,
+                                        const LIFTGRAPH& lifted_graph,
+                                        EVA const& edge_values,
+                                        BalancedEdgeContractionSettings const& settings = BalancedEdgeContractionSettings(),
+                                        VISITOR const& visitor = VISITOR()
+                                        ) :
+                                    original_graph_(original_graph),
+                                    lifted_graph_(lifted_graph),
+                                    edge_values_(copyEdgeValues(lifted_graph, edge_values)),
+                                    original_incidence_(original_graph),
+                                    lifted_incidence_(lifted_graph),
+                                    settings_(settings),
+                                    visitor_(visitor),
+                                    bec_(original_graph, lifted_graph, edge_values_, visitor_)
+                            {
+                                bec_.run(settings_);
+                            }
+
+                            /// Warm start: first joins the clusters of the endpoints of every original
+                            /// edge whose endpoints have the same vertex_labels, then contracts on.
+                            template<typename EVA, typename VLA>
+                                IncrementalBalancedEdgeContraction(
+                                        const ORIGGRAPH& original_graph,
+                                        const LIFTGRAPH& lifted_graph,
+                                        EVA const& edge_values,
+                                        VLA const& vertex_labels,
+                                        BalancedEdgeContractionSettings const& settings = BalancedEdgeContractionSettings(),
+                                        VISITOR const& visitor = VISITOR()
+                                        ) :
+                                    original_graph_(original_graph),
+                                    lifted_graph_(lifted_graph),
+                                    edge_values_(copyEdgeValues(lifted_graph, edge_values)),
+                                    original_incidence_(original_graph),
+                                    lifted_incidence_(lifted_graph),
+                                    settings_(settings),
+                                    visitor_(visitor),
+                                    bec_(original_graph, lifted_graph, edge_values_, visitor_)
+                            {
+                                for (std::size_t e = 0; e < original_graph.numberOfEdges(); ++e)
+                                {
+                                    auto const a = original_graph.vertexOfEdge(e, 0);
+                                    auto const b = original_graph.vertexOfEdge(e, 1);
+                                    if (vertex_labels[a] == vertex_labels[b])
+                                        bec_.join(a, b);
+                                }
+
+                                bec_.run(settings_);
+                            }
+
+                            IncrementalBalancedEdgeContraction(IncrementalBalancedEdgeContraction const&) = delete;
+                            IncrementalBalancedEdgeContraction(IncrementalBalancedEdgeContraction&&) = delete;
+                            IncrementalBalancedEdgeContraction& operator=(IncrementalBalancedEdgeContraction const&) = delete;
+                            IncrementalBalancedEdgeContraction& operator=(IncrementalBalancedEdgeContraction&&) = delete;
+
+                            value_type edgeValue(std::size_t e) const
+                            {
+                                return edge_values_[e];
+                            }
+
+                            /// Changes the cost of the lifted edge e; takes effect with the next run().
+                            void setEdgeValue(std::size_t e, value_type c)
+                            {
+                                edge_values_[e] = c;
+                                changed_.push_back(lifted_graph_.vertexOfEdge(e, 0));
+                                changed_.push_back(lifted_graph_.vertexOfEdge(e, 1));
+                            }
+
+                            /// Solves again after setEdgeValue(). Settings apply from now on.
+                            void run(BalancedEdgeContractionSettings const& settings)
+                            {
+                                settings_ = settings;
+                                run();
+                            }
+
+                            void run()
+                            {
+                                if (!changed_.empty())
+                                {
+                                    bec_.dissolve(changed_, original_incidence_, lifted_incidence_);
+                                    changed_.clear();
+                                }
+
+                                bec_.run(settings_);
+                            }
+
+                            template<typename ELA>
+                                void labelEdges(ELA& edge_labels)
+                                {
+                                    bec_.labelEdges(edge_labels);
+                                }
+
+                            /// Returns a vertex of the cluster of v, the same for all its vertices.
+                            std::size_t clusterOf(std::size_t v)
+                            {
+                                return bec_.clusterOf(v);
+                            }
+
+                            VISITOR& visitor()
+                            {
+                                return visitor_;
+                            }
+
+                        private:
+                            typedef std::vector<value_type> EdgeValues;
+
+                            template<typename EVA>
+                                static EdgeValues copyEdgeValues(const LIFTGRAPH& lifted_graph, EVA const& edge_values)
+                                {
+                                    EdgeValues values(lifted_graph.numberOfEdges());
+                                    for (std::size_t e = 0; e < values.size(); ++e)
+                                        values[e] = static_cast<value_type>(edge_values[e]);
+                                    return values;
+                                }
+
+                            const ORIGGRAPH& original_graph_;
+                            const LIFTGRAPH& lifted_graph_;
+                            EdgeValues edge_values_;
+                            VertexIncidence<typename POLICY::index_type> original_incidence_;
+                            VertexIncidence<typename POLICY::index_type> lifted_incidence_;
+                            BalancedEdgeContractionSettings settings_;
+                            VISITOR visitor_;
+                            BalancedEdgeContraction<POLICY, ORIGGRAPH, LIFTGRAPH, EdgeValues, RULE, VISITOR> bec_;
+                            std::vector<std::size_t> changed_;
+                    };
+
+            } // namespace detail
+
+        } // namespace multicut_lifted
+    } // namespace graph
+} // namespace andres
+
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_INCREMENTAL_HXX
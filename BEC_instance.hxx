@@ -0,0 +1,563 @@
+#pragma once
+#ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_INSTANCE_HXX
+#define ANDRES_GRAPH_MULTICUT_LIFTED_BEC_INSTANCE_HXX
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace andres {
+    namespace graph {
+        namespace multicut_lifted {
+
+            /// Binary lifted multicut instance (.bec), read without copying through mmap.
+            ///
+            /// All integers are in the byte order of the writing machine, which the
+            /// loader checks. Every array starts at a multiple of 8 bytes.
+            ///
+            ///     header                 64 bytes, see BinaryInstanceHeader
+            ///     original offsets       uint64[numberOfVertices + 1]
+            ///     original targets       uint32[numberOfOriginalEdges]
+            ///     original sources       uint32[numberOfOriginalEdges]
+            ///     lifted vertices        uint32[2 * numberOfLiftedEdges]
+            ///     lifted edge costs      float or double[numberOfLiftedEdges]
+            ///
+            /// The original graph is stored in CSR form: the edges of vertex u are
+            /// {u, targets[k]} for offsets[u] <= k < offsets[u + 1], with u < targets[k],
+            /// and k is the index of the edge. sources[k] repeats u, so that both vertices
+            /// of an edge are found in constant time. The lifted graph is a list of edges
+            /// with one cost per edge, in the order given to the writer.
+            ///
+            /// The last byte of the magic is the version of the format, 2 since the
+            /// sources were added.
+            ///
+            struct BinaryInstanceHeader
+            {
+                char magic[8];
+                std::uint32_t byteOrder;
+                std::uint32_t valueSize;
+                std::uint64_t numberOfVertices;
+                std::uint64_t numberOfOriginalEdges;
+                std::uint64_t numberOfLiftedEdges;
+                std::uint64_t reserved[3];
+            };
+
+            namespace detail {
+
+                inline char const* binaryInstanceMagic()
+                {
+                    return "BECLMP\0\2";
+                }
+
+                inline char const* binaryLabelsMagic()
+                {
+                    return "BECLBL\0\1";
+                }
+
+                inline std::uint32_t byteOrderMark()
+                {
+                    return 0x01020304;
+                }
+
+                inline std::size_t align8(std::size_t bytes)
+                {
+                    return (bytes + 7) / 8 * 8;
+                }
+
+                /// Read-only memory mapping of a whole file.
+                class MappedFile
+                {
+                    public:
+                        MappedFile(std::string const& path)
+                        {
+                            int const fd = ::open(path.c_str(), O_RDONLY);
+                            if (fd < 0)
+                                throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+
+                            struct stat status;
+                            if (::fstat(fd, &status) != 0)
+                            {
+                                ::close(fd);
+                                throw std::runtime_error("cannot stat " + path + ": " + std::strerror(errno));
+                            }
+
+                            size_ = static_cast<std::size_t>(status.st_size);
+                            if (size_ > 0)
+                                data_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+                            ::close(fd);
+
+                            if (data_ == MAP_FAILED)
+                            {
+                                data_ = nullptr;
+                                throw std::runtime_error("cannot map " + path + ": " + std::strerror(errno));
+                            }
+                        }
+
+                        ~MappedFile()
+                        {
+                            if (data_ != nullptr)
+                                ::munmap(data_, size_);
+                        }
+
+                        MappedFile(MappedFile const&) = delete;
+                        MappedFile& operator=(MappedFile const&) = delete;
+
+                        char const* data() const
+                        {
+                            return static_cast<char const*>(data_);
+                        }
+
+                        std::size_t size() const
+                        {
+                            return size_;
+                        }
+
+                    private:
+                        void* data_ { nullptr };
+                        std::size_t size_ { 0 };
+                };
+
+                inline void writeOrThrow(std::ofstream& out, void const* data, std::size_t bytes, std::string const& path)
+                {
+                    out.write(static_cast<char const*>(data), static_cast<std::streamsize>(bytes));
+                    if (!out)
+                        throw std::runtime_error("cannot write " + path);
+                }
+
+                inline void padTo8(std::ofstream& out, std::size_t bytes, std::string const& path)
+                {
+                    static char const zeros[8] = { 0 };
+                    writeOrThrow(out, zeros, align8(bytes) - bytes, path);
+                }
+
+            } // namespace detail
+
+            /// Lifted multicut instance mapped from a binary file (see BinaryInstanceHeader).
+            ///
+            /// originalGraph(), liftedGraph() and edgeValues() provide the interface that
+            /// BEC and BEC-cut use, and point directly into the mapping; nothing is
+            /// allocated per vertex or edge. The instance must outlive them.
+            ///
+            template<typename VALUE_TYPE = double>
+                class MappedInstance
+                {
+                    public:
+                        typedef VALUE_TYPE value_type;
+
+                        class OriginalGraph
+                        {
+                            public:
+                                std::size_t numberOfVertices() const
+                                {
+                                    return numberOfVertices_;
+                                }
+
+                                std::size_t numberOfEdges() const
+                                {
+                                    return numberOfEdges_;
+                                }
+
+                                std::size_t vertexOfEdge(std::size_t e, std::size_t j) const
+                                {
+                                    return j == 0 ? sources_[e] : targets_[e];
+                                }
+
+                                /// Number of edges {v, w} with v < w.
+                                std::size_t numberOfEdgesFromVertex(std::size_t v) const
+                                {
+                                    return static_cast<std::size_t>(offsets_[v + 1] - offsets_[v]);
+                                }
+
+                                std::size_t edgeFromVertex(std::size_t v, std::size_t k) const
+                                {
+                                    return static_cast<std::size_t>(offsets_[v]) + k;
+                                }
+
+                            private:
+                                std::size_t numberOfVertices_ { 0 };
+                                std::size_t numberOfEdges_ { 0 };
+                                std::uint64_t const* offsets_ { nullptr };
+                                std::uint32_t const* targets_ { nullptr };
+                                std::uint32_t const* sources_ { nullptr };
+
+                            friend class MappedInstance;
+                        };
+
+                        class LiftedGraph
+                        {
+                            public:
+                                std::size_t numberOfVertices() const
+                                {
+                                    return numberOfVertices_;
+                                }
+
+                                std::size_t numberOfEdges() const
+                                {
+                                    return numberOfEdges_;
+                                }
+
+                                std::size_t vertexOfEdge(std::size_t e, std::size_t j) const
+                                {
+                                    return vertices_[2 * e + j];
+                                }
+
+                            private:
+                                std::size_t numberOfVertices_ { 0 };
+                                std::size_t numberOfEdges_ { 0 };
+                                std::uint32_t const* vertices_ { nullptr };
+
+                            friend class MappedInstance;
+                        };
+
+                        class EdgeValues
+                        {
+                            public:
+                                typedef VALUE_TYPE value_type;
+
+                                value_type const& operator[](std::size_t e) const
+                                {
+                                    return values_[e];
+                                }
+
+                                std::size_t size() const
+                                {
+                                    return size_;
+                                }
+
+                                value_type const* begin() const
+                                {
+                                    return values_;
+                                }
+
+                                value_type const* end() const
+                                {
+                                    return values_ + size_;
+                                }
+
+                            private:
+                                value_type const* values_ { nullptr };
+                                std::size_t size_ { 0 };
+
+                            friend class MappedInstance;
+                        };
+
+                        /// With validate, every vertex index in the file is checked to be smaller
+                        /// than numberOfVertices and the offsets to be non-decreasing, which reads
+                        /// the whole graph once. Without it, only the header and the file size are
+                        /// checked, and a corrupt file leads to undefined behaviour in the solver.
+                        MappedInstance(std::string const& path, bool validate = false) :
+                            file_(path)
+                        {
+                            if (file_.size() < sizeof(BinaryInstanceHeader))
+                                throw std::runtime_error(path + " is not a BEC instance (too short)");
+
+                            BinaryInstanceHeader header;
+                            std::memcpy(&header, file_.data(), sizeof(header));
+
+                            if (std::memcmp(header.magic, detail::binaryInstanceMagic(), sizeof(header.magic) - 1) != 0)
+                                throw std::runtime_error(path + " is not a BEC instance");
+                            if (header.magic[7] != detail::binaryInstanceMagic()[7])
+                                throw std::runtime_error(path + " is a BEC instance of format version " + std::to_string(static_cast<int>(header.magic[7]))
+                                        + ", expected " + std::to_string(static_cast<int>(detail::binaryInstanceMagic()[7])) + "; write it again");
+                            if (header.byteOrder != detail::byteOrderMark())
+                                throw std::runtime_error(path + " was written on a machine with a different byte order");
+                            if (header.valueSize != sizeof(value_type))
+                                throw std::runtime_error(path + " stores costs of " + std::to_string(header.valueSize) + " bytes, expected " + std::to_string(sizeof(value_type)));
+
+                            auto const n = static_cast<std::size_t>(header.numberOfVertices);
+                            auto const m_original = static_cast<std::size_t>(header.numberOfOriginalEdges);
+                            auto const m_lifted = static_cast<std::size_t>(header.numberOfLiftedEdges);
+
+                            // every count is checked against the remaining bytes by division,
+                            // so that a corrupt header cannot overflow the offset computation
+                            auto offset = sizeof(BinaryInstanceHeader);
+                            auto const section = [&](std::size_t count, std::size_t elementSize) -> std::size_t
+                            {
+                                auto const at = offset;
+                                if (count > (file_.size() - offset) / elementSize)
+                                    throw std::runtime_error(path + " is truncated");
+                                offset += count * elementSize;
+                                offset = std::min(detail::align8(offset), file_.size());
+                                return at;
+                            };
+
+                            if (n >= (file_.size() - offset) / sizeof(std::uint64_t))
+                                throw std::runtime_error(path + " is truncated");
+                            auto const offsets_at = section(n + 1, sizeof(std::uint64_t));
+                            auto const targets_at = section(m_original, sizeof(std::uint32_t));
+                            auto const sources_at = section(m_original, sizeof(std::uint32_t));
+                            if (m_lifted > (file_.size() - offset) / (2 * sizeof(std::uint32_t)))
+                                throw std::runtime_error(path + " is truncated");
+                            auto const lifted_at = section(2 * m_lifted, sizeof(std::uint32_t));
+                            auto const values_at = section(m_lifted, sizeof(value_type));
+
+                            original_graph_.numberOfVertices_ = n;
+                            original_graph_.numberOfEdges_ = m_original;
+                            original_graph_.offsets_ = reinterpret_cast<std::uint64_t const*>(file_.data() + offsets_at);
+                            original_graph_.targets_ = reinterpret_cast<std::uint32_t const*>(file_.data() + targets_at);
+                            original_graph_.sources_ = reinterpret_cast<std::uint32_t const*>(file_.data() + sources_at);
+
+                            if (original_graph_.offsets_[0] != 0 || original_graph_.offsets_[n] != m_original)
+                                throw std::runtime_error(path + " has inconsistent original graph offsets");
+
+                            lifted_graph_.numberOfVertices_ = n;
+                            lifted_graph_.numberOfEdges_ = m_lifted;
+                            lifted_graph_.vertices_ = reinterpret_cast<std::uint32_t const*>(file_.data() + lifted_at);
+
+                            edge_values_.values_ = reinterpret_cast<value_type const*>(file_.data() + values_at);
+                            edge_values_.size_ = m_lifted;
+
+                            if (validate)
+                                validateVertices(path);
+                        }
+
+                        OriginalGraph const& originalGraph() const
+                        {
+                            return original_graph_;
+                        }
+
+                        LiftedGraph const& liftedGraph() const
+                        {
+                            return lifted_graph_;
+                        }
+
+                        EdgeValues const& edgeValues() const
+                        {
+                            return edge_values_;
+                        }
+
+                    private:
+                        void validateVertices(std::string const& path) const
+                        {
+                            auto const n = original_graph_.numberOfVertices_;
+
+                            for (std::size_t u = 0; u < n; ++u)
+                            {
+                                auto const begin = original_graph_.offsets_[u];
+                                auto const end = original_graph_.offsets_[u + 1];
+                                if (end < begin)
+                                    throw std::runtime_error(path + " has decreasing original graph offsets at vertex " + std::to_string(u));
+
+                                for (auto k = begin; k < end; ++k)
+                                {
+                                    if (original_graph_.targets_[k] <= u || original_graph_.targets_[k] >= n)
+                                        throw std::runtime_error(path + " has an invalid target in original edge " + std::to_string(k));
+                                    if (original_graph_.sources_[k] != u)
+                                        throw std::runtime_error(path + " has an invalid source in original edge " + std::to_string(k));
+                                }
+                            }
+
+                            for (std::size_t e = 0; e < 2 * lifted_graph_.numberOfEdges_; ++e)
+                                if (lifted_graph_.vertices_[e] >= n)
+                                    throw std::runtime_error(path + " has an invalid vertex in lifted edge " + std::to_string(e / 2));
+                        }
+
+                        detail::MappedFile file_;
+                        OriginalGraph original_graph_;
+                        LiftedGraph lifted_graph_;
+                        EdgeValues edge_values_;
+                };
+
+            /// Writes a lifted multicut instance in the binary format read by MappedInstance.
+            ///
+            /// Costs are converted to VALUE_TYPE (float or double). Vertex indices must
+            /// fit into 32 bits.
+            ///
+            template<typename VALUE_TYPE, typename ORIGGRAPH, typename LIFTGRAPH, typename EVA>
+                void writeBinaryInstance(
+                        std::string const& path,
+                        const ORIGGRAPH& original_graph,
+                        const LIFTGRAPH& lifted_graph,
+                        EVA const& edge_values
+                        )
+                {
+                    auto const n = original_graph.numberOfVertices();
+                    if (n >= static_cast<std::size_t>(UINT32_MAX))
+                        throw std::runtime_error("binary instances support at most 2^32 - 1 vertices");
+                    if (lifted_graph.numberOfVertices() != n)
+                        throw std::runtime_error("original and lifted graph differ in the number of vertices");
+
+                    // CSR of the original graph, every edge stored at its smaller vertex
+                    std::vector<std::uint64_t> offsets(n + 1, 0);
+                    for (std::size_t e = 0; e < original_graph.numberOfEdges(); ++e)
+                        ++offsets[std::min(original_graph.vertexOfEdge(e, 0), original_graph.vertexOfEdge(e, 1)) + 1];
+                    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+                    std::vector<std::uint32_t> targets(original_graph.numberOfEdges());
+                    {
+                        std::vector<std::uint64_t> next(offsets.begin(), offsets.end() - 1);
+                        for (std::size_t e = 0; e < original_graph.numberOfEdges(); ++e)
+                        {
+                            auto const a = original_graph.vertexOfEdge(e, 0);
+                            auto const b = original_graph.vertexOfEdge(e, 1);
+                            targets[next[std::min(a, b)]++] = static_cast<std::uint32_t>(std::max(a, b));
+                        }
+                    }
+                    for (std::size_t v = 0; v < n; ++v)
+                        std::sort(targets.begin() + offsets[v], targets.begin() + offsets[v + 1]);
+
+                    BinaryInstanceHeader header;
+                    std::memset(&header, 0, sizeof(header));
+                    std::memcpy(header.magic, detail::binaryInstanceMagic(), sizeof(header.magic));
+                    header.byteOrder = detail::byteOrderMark();
+                    header.valueSize = sizeof(VALUE_TYPE);
+                    header.numberOfVertices = n;
+                    header.numberOfOriginalEdges = original_graph.numberOfEdges();
+                    header.numberOfLiftedEdges = lifted_graph.numberOfEdges();
+
+                    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                    if (!out)
+                        throw std::runtime_error("cannot open " + path + " for writing");
+
+                    detail::writeOrThrow(out, &header, sizeof(header), path);
+                    detail::writeOrThrow(out, offsets.data(), offsets.size() * sizeof(std::uint64_t), path);
+                    detail::writeOrThrow(out, targets.data(), targets.size() * sizeof(std::uint32_t), path);
+                    detail::padTo8(out, targets.size() * sizeof(std::uint32_t), path);
+
+                    // sources: the vertex u of every edge, reusing the buffer of the targets
+                    for (std::size_t v = 0; v < n; ++v)
+                        std::fill(targets.begin() + offsets[v], targets.begin() + offsets[v + 1], static_cast<std::uint32_t>(v));
+                    detail::writeOrThrow(out, targets.data(), targets.size() * sizeof(std::uint32_t), path);
+                    detail::padTo8(out, targets.size() * sizeof(std::uint32_t), path);
+
+                    // the lifted graph is streamed in blocks, so that no copy of it is held in memory
+                    std::size_t const block = 1 << 16;
+                    std::vector<std::uint32_t> vertices;
+                    std::vector<VALUE_TYPE> values;
+                    vertices.reserve(2 * block);
+                    values.reserve(block);
+
+                    for (std::size_t begin = 0; begin < lifted_graph.numberOfEdges(); begin += block)
+                    {
+                        auto const end = std::min(begin + block, lifted_graph.numberOfEdges());
+                        vertices.clear();
+                        for (auto e = begin; e < end; ++e)
+                        {
+                            vertices.push_back(static_cast<std::uint32_t>(lifted_graph.vertexOfEdge(e, 0)));
+                            vertices.push_back(static_cast<std::uint32_t>(lifted_graph.vertexOfEdge(e, 1)));
+                        }
+                        detail::writeOrThrow(out, vertices.data(), vertices.size() * sizeof(std::uint32_t), path);
+                    }
+                    detail::padTo8(out, 2 * lifted_graph.numberOfEdges() * sizeof(std::uint32_t), path);
+
+                    for (std::size_t begin = 0; begin < lifted_graph.numberOfEdges(); begin += block)
+                    {
+                        auto const end = std::min(begin + block, lifted_graph.numberOfEdges());
+                        values.clear();
+                        for (auto e = begin; e < end; ++e)
+                            values.push_back(static_cast<VALUE_TYPE>(edge_values[e]));
+                        detail::writeOrThrow(out, values.data(), values.size() * sizeof(VALUE_TYPE), path);
+                    }
+                }
+
+            /// Computes the vertex labeling (clusters numbered 0, 1, ... in order of their
+            /// smallest vertex) from edge labels of the lifted graph, as written by BEC and
+            /// BEC-cut. Clusters are the components of the uncut lifted edges.
+            ///
+            template<typename LIFTGRAPH, typename ELA, typename VLA>
+                std::size_t edgeToVertexLabels(
+                        const LIFTGRAPH& lifted_graph,
+                        ELA const& edge_labels,
+                        VLA& vertex_labels
+                        )
+                {
+                    std::vector<std::size_t> parents(lifted_graph.numberOfVertices());
+                    std::iota(parents.begin(), parents.end(), std::size_t());
+
+                    auto find = [&](std::size_t v)
+                    {
+                        while (parents[v] != v)
+                            v = parents[v] = parents[parents[v]];
+                        return v;
+                    };
+
+                    for (std::size_t e = 0; e < lifted_graph.numberOfEdges(); ++e)
+                        if (!edge_labels[e])
+                        {
+                            auto const a = find(lifted_graph.vertexOfEdge(e, 0));
+                            auto const b = find(lifted_graph.vertexOfEdge(e, 1));
+                            if (a != b)
+                                parents[std::max(a, b)] = std::min(a, b);
+                        }
+
+                    // roots are the smallest vertices of their clusters
+                    std::size_t numberOfClusters = 0;
+                    for (std::size_t v = 0; v < parents.size(); ++v)
+                    {
+                        auto const root = find(v);
+                        if (root == v)
+                            vertex_labels[v] = numberOfClusters++;
+                        else
+                            vertex_labels[v] = vertex_labels[root];
+                    }
+
+                    return numberOfClusters;
+                }
+
+            namespace detail {
+
+                template<typename T, typename LABELS>
+                    void writeBinaryLabels(std::string const& path, LABELS const& labels, std::size_t size)
+                    {
+                        BinaryInstanceHeader header;
+                        std::memset(&header, 0, sizeof(header));
+                        std::memcpy(header.magic, binaryLabelsMagic(), sizeof(header.magic));
+                        header.byteOrder = byteOrderMark();
+                        header.valueSize = sizeof(T);
+                        header.numberOfVertices = size;
+
+                        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                        if (!out)
+                            throw std::runtime_error("cannot open " + path + " for writing");
+
+                        writeOrThrow(out, &header, sizeof(header), path);
+
+                        std::size_t const block = 1 << 16;
+                        std::vector<T> buffer;
+                        buffer.reserve(block);
+                        for (std::size_t begin = 0; begin < size; begin += block)
+                        {
+                            buffer.clear();
+                            for (auto i = begin; i < std::min(begin + block, size); ++i)
+                                buffer.push_back(static_cast<T>(labels[i]));
+                            writeOrThrow(out, buffer.data(), buffer.size() * sizeof(T), path);
+                        }
+                    }
+
+            } // namespace detail
+
+            /// Writes edge labels (0 = join, 1 = cut) as one byte per lifted edge after a
+            /// 64 byte header (magic "BECLBL", valueSize 1, count in numberOfVertices).
+            ///
+            template<typename ELA>
+                void writeBinaryEdgeLabels(std::string const& path, ELA const& edge_labels, std::size_t numberOfEdges)
+                {
+                    detail::writeBinaryLabels<std::uint8_t>(path, edge_labels, numberOfEdges);
+                }
+
+            /// Writes a vertex labeling (partition) as one uint32 per vertex after a 64 byte
+            /// header (magic "BECLBL", valueSize 4, count in numberOfVertices).
+            ///
+            template<typename VLA>
+                void writeBinaryVertexLabels(std::string const& path, VLA const& vertex_labels, std::size_t numberOfVertices)
+                {
+                    detail::writeBinaryLabels<std::uint32_t>(path, vertex_labels, numberOfVertices);
+                }
+
+        } // namespace multicut_lifted
+    } // namespace graph
+} // namespace andres
+
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_INSTANCE_HXX
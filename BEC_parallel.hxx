@@ -0,0 +1,171 @@
+#pragma once
+#ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_PARALLEL_HXX
+#define ANDRES_GRAPH_MULTICUT_LIFTED_BEC_PARALLEL_HXX
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace andres {
+    namespace graph {
+        namespace multicut_lifted {
+
+            /// Fixed set of worker threads for the parallel modes of BEC and BEC-cut.
+            ///
+            /// The workers are started once and reused by every call of parallelFor(),
+            /// so rounds of a few hundred small tasks do not pay for thread creation.
+            ///
+            class ThreadPool
+            {
+                public:
+                    /// numberOfThreads == 0 uses one thread per hardware thread.
+                    ThreadPool(std::size_t numberOfThreads = 0)
+                    {
+                        if (numberOfThreads == 0)
+                            numberOfThreads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+                        for (std::size_t i = 1; i < numberOfThreads; ++i)
+                            workers_.emplace_back(&ThreadPool::work, this, i);
+                    }
+
+                    ~ThreadPool()
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(mutex_);
+                            stop_ = true;
+                        }
+                        wake_.notify_all();
+
+                        for (auto& worker : workers_)
+                            worker.join();
+                    }
+
+                    ThreadPool(ThreadPool const&) = delete;
+                    ThreadPool& operator=(ThreadPool const&) = delete;
+
+                    std::size_t numberOfThreads() const
+                    {
+                        return workers_.size() + 1;
+                    }
+
+                    /// Calls f(thread, i) for i = 0, ..., n-1 and returns when all calls are done.
+                    ///
+                    /// The calling thread takes part as thread 0. Indices are handed out one
+                    /// at a time, so tasks of very different cost are balanced. The first
+                    /// exception thrown by f is rethrown here.
+                    ///
+                    template<typename F>
+                        void parallelFor(std::size_t n, F const& f)
+                        {
+                            if (workers_.empty() || n < 2)
+                            {
+                                for (std::size_t i = 0; i < n; ++i)
+                                    f(0, i);
+                                return;
+                            }
+
+                            Job job(n, &ThreadPool::call<F>, &f);
+                            {
+                                std::lock_guard<std::mutex> lock(mutex_);
+                                job_ = &job;
+                                busy_ = workers_.size();
+                                ++generation_;
+                            }
+                            wake_.notify_all();
+
+                            run(job, 0);
+
+                            {
+                                std::unique_lock<std::mutex> lock(mutex_);
+                                done_.wait(lock, [this] { return busy_ == 0; });
+                                job_ = nullptr;
+                            }
+
+                            if (job.exception)
+                                std::rethrow_exception(job.exception);
+                        }
+
+                private:
+                    struct Job
+                    {
+                        Job(std::size_t _size, void (*_function)(void const*, std::size_t, std::size_t), void const* _context) :
+                            size(_size),
+                            next(0),
+                            function(_function),
+                            context(_context)
+                        {}
+
+                        std::size_t size;
+                        std::atomic<std::size_t> next;
+                        void (*function)(void const*, std::size_t, std::size_t);
+                        void const* context;
+                        std::mutex mutex;
+                        std::exception_ptr exception;
+                    };
+
+                    template<typename F>
+                        static void call(void const* f, std::size_t thread, std::size_t i)
+                        {
+                            (*static_cast<F const*>(f))(thread, i);
+                        }
+
+                    static void run(Job& job, std::size_t thread)
+                    {
+                        for (std::size_t i; (i = job.next++) < job.size; )
+                            try
+                            {
+                                job.function(job.context, thread, i);
+                            }
+                            catch (...)
+                            {
+                                std::lock_guard<std::mutex> lock(job.mutex);
+                                if (!job.exception)
+                                    job.exception = std::current_exception();
+                                job.next = job.size;
+                            }
+                    }
+
+                    void work(std::size_t thread)
+                    {
+                        std::size_t generation = 0;
+                        for (;;)
+                        {
+                            Job* job;
+                            {
+                                std::unique_lock<std::mutex> lock(mutex_);
+                                wake_.wait(lock, [&] { return stop_ || generation_ != generation; });
+                                if (stop_)
+                                    return;
+
+                                generation = generation_;
+                                job = job_;
+                            }
+
+                            run(*job, thread);
+
+                            std::lock_guard<std::mutex> lock(mutex_);
+                            if (--busy_ == 0)
+                                done_.notify_one();
+                        }
+                    }
+
+                    std::vector<std::thread> workers_;
+                    std::mutex mutex_;
+                    std::condition_variable wake_;
+                    std::condition_variable done_;
+                    Job* job_ { nullptr };
+                    std::size_t busy_ { 0 };
+                    std::size_t generation_ { 0 };
+                    bool stop_ { false };
+            };
+
+        } // namespace multicut_lifted
+    } // namespace graph
+} // namespace andres
+
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_PARALLEL_HXX
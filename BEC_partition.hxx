@@ -0,0 +1,142 @@
+#pragma once
+#ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_PARTITION_HXX
+#define ANDRES_GRAPH_MULTICUT_LIFTED_BEC_PARTITION_HXX
+
+#include <atomic>
+#include <cstddef>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace andres {
+    namespace graph {
+        namespace multicut_lifted {
+
+            /// Partition of the vertices of a contraction. (used by BEC and BEC-cut)
+            ///
+            /// A disjoint-set forest in which the root of every set is the vertex that
+            /// stands for the set in the contracted graphs, i.e. the stable vertex of
+            /// the last contraction, so find() maps a vertex to its contracted vertex.
+            /// The members of every set form a circular list, so that a set can be
+            /// enumerated and split up into singletons again. Vertices are stored as INDEX.
+            ///
+            template<typename INDEX = std::size_t>
+                class ContractionPartition
+                {
+                    public:
+                        ContractionPartition(std::size_t numberOfElements) :
+                            parents_(numberOfElements),
+                            next_(numberOfElements)
+                    {
+                        std::iota(parents_.begin(), parents_.end(), INDEX());
+                        std::iota(next_.begin(), next_.end(), INDEX());
+                    }
+
+                        std::size_t numberOfElements() const
+                        {
+                            return parents_.size();
+                        }
+
+                        std::size_t find(std::size_t v)
+                        {
+                            while (parents_[v] != v)
+                                v = parents_[v] = parents_[parents_[v]];
+                            return v;
+                        }
+
+                        /// Joins the set of merge_root into that of stable_root; both must be roots.
+                        void merge(std::size_t stable_root, std::size_t merge_root)
+                        {
+                            parents_[merge_root] = static_cast<INDEX>(stable_root);
+                            std::swap(next_[stable_root], next_[merge_root]);
+                        }
+
+                        /// Calls f(v) for every member v of the set of root.
+                        template<typename F>
+                            void forEachMember(std::size_t root, F f) const
+                            {
+                                auto v = root;
+                                do
+                                {
+                                    f(v);
+                                    v = next_[v];
+                                }
+                                while (v != root);
+                            }
+
+                        /// Makes v a singleton. Must be applied to all members of a set at once.
+                        void isolate(std::size_t v)
+                        {
+                            parents_[v] = static_cast<INDEX>(v);
+                            next_[v] = static_cast<INDEX>(v);
+                        }
+
+                    private:
+                        std::vector<INDEX> parents_;
+                        std::vector<INDEX> next_;
+                };
+
+            /// Disjoint-set forest that threads can join concurrently, without locks. (used by the pre-contraction)
+            ///
+            /// A root is only ever linked below a smaller root, by compare-and-swap, so
+            /// the root of every set is its smallest element and the sets do not depend
+            /// on the order in which the unions happen. find() halves paths with
+            /// compare-and-swap as well, which never moves a vertex out of its set.
+            ///
+            class ConcurrentPartition
+            {
+                public:
+                    ConcurrentPartition(std::size_t numberOfElements) :
+                        parents_(numberOfElements)
+                {
+                    for (std::size_t v = 0; v < numberOfElements; ++v)
+                        parents_[v].store(v, std::memory_order_relaxed);
+                }
+
+                    std::size_t numberOfElements() const
+                    {
+                        return parents_.size();
+                    }
+
+                    std::size_t find(std::size_t v)
+                    {
+                        for (;;)
+                        {
+                            auto parent = parents_[v].load();
+                            if (parent == v)
+                                return v;
+
+                            auto const grandparent = parents_[parent].load();
+                            if (grandparent != parent)
+                                parents_[v].compare_exchange_weak(parent, grandparent);
+                            v = grandparent;
+                        }
+                    }
+
+                    void merge(std::size_t a, std::size_t b)
+                    {
+                        for (;;)
+                        {
+                            a = find(a);
+                            b = find(b);
+                            if (a == b)
+                                return;
+                            if (a < b)
+                                std::swap(a, b);
+
+                            // fails if another thread linked a in the meantime
+                            auto expected = a;
+                            if (parents_[a].compare_exchange_strong(expected, b))
+                                return;
+                        }
+                    }
+
+                private:
+                    std::vector<std::atomic<std::size_t>> parents_;
+            };
+
+        } // namespace multicut_lifted
+    } // namespace graph
+} // namespace andres
+
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_PARTITION_HXX
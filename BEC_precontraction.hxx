@@ -0,0 +1,144 @@
+#pragma once
+#ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_PRECONTRACTION_HXX
+#define ANDRES_GRAPH_MULTICUT_LIFTED_BEC_PRECONTRACTION_HXX
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "andres/graph/multicut-lifted/BEC_cluster.hxx"
+#include "andres/graph/multicut-lifted/BEC_core.hxx"
+#include "andres/graph/multicut-lifted/BEC_graph.hxx"
+#include "andres/graph/multicut-lifted/BEC_parallel.hxx"
+#include "andres/graph/multicut-lifted/BEC_partition.hxx"
+#include "andres/graph/multicut-lifted/BEC_visitor.hxx"
+
+namespace andres {
+    namespace graph {
+        namespace multicut_lifted {
+
+            namespace detail {
+
+                /// Whether an edge of graph joins a and b, looked up in the shorter of their incidence lists.
+                template<typename GRAPH, typename INDEX>
+                    bool adjacent(GRAPH const& graph, VertexIncidence<INDEX> const& incidence, std::size_t a, std::size_t b)
+                    {
+                        if (incidence.end(a) - incidence.begin(a) > incidence.end(b) - incidence.begin(b))
+                            std::swap(a, b);
+
+                        for (auto e = incidence.begin(a); e != incidence.end(a); ++e)
+                            if (graph.vertexOfEdge(*e, 0) == b || graph.vertexOfEdge(*e, 1) == b)
+                                return true;
+                        return false;
+                    }
+
+                /// BEC or BEC-cut (RULE) after a parallel pre-contraction of strongly attractive edges.
+                ///
+                /// 1. Every lifted edge whose cost is greater than
+                ///    settings.preContractionThreshold and whose endpoints are joined by an
+                ///    original edge is contracted by a ConcurrentPartition, on
+                ///    settings.preContractionThreads threads. The clusters are the connected
+                ///    components of these edges.
+                /// 2. The original and lifted graphs of the clusters, with summed lifted
+                ///    costs, are built by ClusterGraphs on the same threads.
+                /// 3. The greedy contraction, with the settings given, continues on the
+                ///    graphs of the clusters, starting from the number of merges that formed
+                ///    them (see BalancedEdgeContraction). Its own state (graph copy and
+                ///    queue) is built as for any contraction, sequentially.
+                ///
+                /// The clusters and their graphs do not depend on the number of threads.
+                /// If no edge is contracted, this is the plain contraction.
+                ///
+                template<typename POLICY, typename RULE, typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename ELA, typename VISITOR>
+                    void preContractedBalancedEdgeContraction(
+                            const ORIGGRAPH& original_graph,
+                            const LIFTGRAPH& lifted_graph,
+                            EVA const& edge_values,
+                            ELA& edge_labels,
+                            BalancedEdgeContractionSettings const& settings,
+                            VISITOR& visitor
+                            )
+                    {
+                        typedef typename POLICY::value_type value_type;
+                        typedef ClusterGraphs<value_type> Clusters;
+
+                        auto const n = original_graph.numberOfVertices();
+
+                        visitor.beginPhase(BalancedEdgeContractionPhase::PreContraction);
+
+                        // labels[v]: the cluster of v, numbered in the order of their smallest vertex
+                        std::vector<std::size_t> labels(n);
+                        std::size_t k = 0;
+                        Clusters clusters;
+
+                        // the threads of the pre-contraction are stopped before the contraction starts its own
+                        {
+                            ThreadPool pool(settings.preContractionThreads);
+
+                            {
+                                ConcurrentPartition partition(n);
+                                {
+                                    VertexIncidence<> const incidence(original_graph);
+
+                                    auto const chunks = pool.numberOfThreads();
+                                    auto const m = lifted_graph.numberOfEdges();
+                                    auto const chunk_size = (m + chunks - 1) / chunks;
+                                    pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                            {
+                                            auto const end = std::min(m, (c + 1) * chunk_size);
+                                            for (auto e = c * chunk_size; e < end; ++e)
+                                            {
+                                                if (!(static_cast<double>(edge_values[e]) > settings.preContractionThreshold))
+                                                    continue;
+
+                                                auto const a = lifted_graph.vertexOfEdge(e, 0);
+                                                auto const b = lifted_graph.vertexOfEdge(e, 1);
+                                                if (a != b && adjacent(original_graph, incidence, a, b))
+                                                    partition.merge(a, b);
+                                            }
+                                            });
+                                }
+
+                                k = numberClusters(partition, labels, pool);
+                            }
+
+                            if (k != n)
+                                clusters = Clusters(original_graph, lifted_graph, edge_values, labels, k, pool);
+                        }
+
+                        visitor.endPhase(BalancedEdgeContractionPhase::PreContraction);
+                        visitor.preContracted(n, k);
+
+                        if (k == n)
+                        {
+                            BalancedEdgeContraction<POLICY, ORIGGRAPH, LIFTGRAPH, EVA, RULE, VISITOR>
+                                bec(original_graph, lifted_graph, edge_values, visitor);
+                            bec.run(settings);
+                            bec.labelEdges(edge_labels);
+                            return;
+                        }
+
+                        std::vector<std::size_t> cluster_labels(k);
+                        {
+                            BalancedEdgeContraction<POLICY, TileGraph, TileGraph, typename Clusters::Costs, RULE, VISITOR>
+                                bec(clusters.original, clusters.lifted, clusters.costs, clusters.sizes, n, visitor);
+                            bec.run(settings);
+                            bec.labelVertices(cluster_labels);
+                        }
+
+                        visitor.beginPhase(BalancedEdgeContractionPhase::Labeling);
+
+                        for (std::size_t e = 0; e < lifted_graph.numberOfEdges(); ++e)
+                            edge_labels[e] = cluster_labels[labels[lifted_graph.vertexOfEdge(e, 0)]] == cluster_labels[labels[lifted_graph.vertexOfEdge(e, 1)]] ? 0 : 1;
+
+                        visitor.endPhase(BalancedEdgeContractionPhase::Labeling);
+                    }
+
+            } // namespace detail
+
+        } // namespace multicut_lifted
+    } // namespace graph
+} // namespace andres
+
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_PRECONTRACTION_HXX
@@ -0,0 +1,196 @@
+#pragma once
+#ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_QUEUE_HXX
+#define ANDRES_GRAPH_MULTICUT_LIFTED_BEC_QUEUE_HXX
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace andres {
+    namespace graph {
+        namespace multicut_lifted {
+
+            /// Addressable d-ary max-heap over the keys 0, ..., n-1. (used by BEC and BEC-cut)
+            ///
+            /// Every key is in the queue at most once. push() inserts a key or changes
+            /// its priority in place, erase() removes it, so the queue never holds stale
+            /// entries and its size is bounded by the number of live keys. Like
+            /// std::priority_queue, top() is the largest element with respect to COMPARE.
+            /// Keys and heap positions are stored as INDEX.
+            ///
+            template<typename T, typename COMPARE = std::less<T>, std::size_t ARITY = 4, typename INDEX = std::size_t>
+                class IndexedPriorityQueue
+                {
+                    public:
+                        typedef T value_type;
+                        typedef INDEX index_type;
+
+                        IndexedPriorityQueue(std::size_t numberOfKeys, COMPARE const& compare = COMPARE()) :
+                            positions_(numberOfKeys, npos()),
+                            compare_(compare)
+                    {}
+
+                        bool empty() const
+                        {
+                            return heap_.empty();
+                        }
+
+                        std::size_t size() const
+                        {
+                            return heap_.size();
+                        }
+
+                        bool contains(std::size_t key) const
+                        {
+                            return positions_[key] != npos();
+                        }
+
+                        /// Priority of a queued key.
+                        value_type const& value(std::size_t key) const
+                        {
+                            assert(contains(key));
+                            return heap_[positions_[key]].value;
+                        }
+
+                        value_type const& top() const
+                        {
+                            assert(!empty());
+                            return heap_.front().value;
+                        }
+
+                        std::size_t topKey() const
+                        {
+                            assert(!empty());
+                            return heap_.front().key;
+                        }
+
+                        /// Inserts key with the given priority, or changes the priority if key is already queued.
+                        void push(std::size_t key, value_type const& value)
+                        {
+                            auto const position = positions_[key];
+                            if (position == npos())
+                            {
+                                heap_.push_back(Entry(value, key));
+                                siftUp(heap_.size() - 1);
+                            }
+                            else if (compare_(heap_[position].value, value))
+                            {
+                                heap_[position].value = value;
+                                siftUp(position);
+                            }
+                            else
+                            {
+                                heap_[position].value = value;
+                                siftDown(position);
+                            }
+                        }
+
+                        void pop()
+                        {
+                            assert(!empty());
+                            removeAt(0);
+                        }
+
+                        /// Removes key from the queue; does nothing if key is not queued.
+                        void erase(std::size_t key)
+                        {
+                            auto const position = positions_[key];
+                            if (position != npos())
+                                removeAt(position);
+                        }
+
+                    private:
+                        struct Entry
+                        {
+                            Entry(value_type const& _value, std::size_t _key) :
+                                value(_value),
+                                key(static_cast<index_type>(_key))
+                            {}
+
+                            value_type value;
+                            index_type key;
+                        };
+
+                        static index_type npos()
+                        {
+                            return std::numeric_limits<index_type>::max();
+                        }
+
+                        void removeAt(std::size_t position)
+                        {
+                            positions_[heap_[position].key] = npos();
+
+                            if (position + 1 == heap_.size())
+                            {
+                                heap_.pop_back();
+                                return;
+                            }
+
+                            heap_[position] = heap_.back();
+                            heap_.pop_back();
+                            positions_[heap_[position].key] = static_cast<index_type>(position);
+
+                            if (position > 0 && compare_(heap_[(position - 1) / ARITY].value, heap_[position].value))
+                                siftUp(position);
+                            else
+                                siftDown(position);
+                        }
+
+                        void siftUp(std::size_t position)
+                        {
+                            Entry entry = heap_[position];
+                            while (position > 0)
+                            {
+                                auto const parent = (position - 1) / ARITY;
+                                if (!compare_(heap_[parent].value, entry.value))
+                                    break;
+
+                                heap_[position] = heap_[parent];
+                                positions_[heap_[position].key] = static_cast<index_type>(position);
+                                position = parent;
+                            }
+
+                            heap_[position] = entry;
+                            positions_[entry.key] = static_cast<index_type>(position);
+                        }
+
+                        void siftDown(std::size_t position)
+                        {
+                            Entry entry = heap_[position];
+                            for (;;)
+                            {
+                                auto const first = position * ARITY + 1;
+                                if (first >= heap_.size())
+                                    break;
+
+                                auto const last = std::min(first + ARITY, heap_.size());
+                                auto child = first;
+                                for (auto i = first + 1; i < last; ++i)
+                                    if (compare_(heap_[child].value, heap_[i].value))
+                                        child = i;
+
+                                if (!compare_(entry.value, heap_[child].value))
+                                    break;
+
+                                heap_[position] = heap_[child];
+                                positions_[heap_[position].key] = static_cast<index_type>(position);
+                                position = child;
+                            }
+
+                            heap_[position] = entry;
+                            positions_[entry.key] = static_cast<index_type>(position);
+                        }
+
+                        std::vector<Entry> heap_;
+                        std::vector<index_type> positions_;
+                        COMPARE compare_;
+                };
+
+        } // namespace multicut_lifted
+    } // namespace graph
+} // namespace andres
+
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_QUEUE_HXX
@@ -0,0 +1,363 @@
+#pragma once
+#ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_TILED_HXX
+#define ANDRES_GRAPH_MULTICUT_LIFTED_BEC_TILED_HXX
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "andres/graph/multicut-lifted/BEC_cluster.hxx"
+#include "andres/graph/multicut-lifted/BEC_core.hxx"
+#include "andres/graph/multicut-lifted/BEC_graph.hxx"
+#include "andres/graph/multicut-lifted/BEC_parallel.hxx"
+#include "andres/graph/multicut-lifted/BEC_partition.hxx"
+#include "andres/graph/multicut-lifted/BEC_visitor.hxx"
+
+namespace andres {
+    namespace graph {
+        namespace multicut_lifted {
+
+            /// Tiling of a grid graph for the tiled mode of BEC and BEC-cut.
+            ///
+            /// The vertices of the graphs are the voxels of a width x height x depth grid
+            /// (depth 1 for images), vertex x + width * (y + height * z). The grid is cut
+            /// into tiles of tileSize^3 (tileSize^2 for images) voxels. Every tile is
+            /// solved on its own, together with a margin of overlap voxels around it,
+            /// on numberOfThreads threads (0: all hardware threads). Lifted edges should
+            /// be shorter than overlap, so that every edge near a tile is seen whole.
+            ///
+            struct BalancedEdgeContractionTiling
+            {
+                std::size_t width { 0 };
+                std::size_t height { 1 };
+                std::size_t depth { 1 };
+                std::size_t tileSize { 256 };
+                std::size_t overlap { 16 };
+                std::size_t numberOfThreads { 0 };
+            };
+
+            namespace detail {
+
+                /// Tiles of a grid and the box (tile and margin) of each tile.
+                class GridTiles
+                {
+                    public:
+                        GridTiles(BalancedEdgeContractionTiling const& tiling, std::size_t numberOfVertices) :
+                            tileSize_(std::max<std::size_t>(1, tiling.tileSize)),
+                            overlap_(std::min(tiling.overlap, std::max<std::size_t>(1, tiling.tileSize)))
+                        {
+                            shape_[0] = tiling.width;
+                            shape_[1] = tiling.height;
+                            shape_[2] = tiling.depth;
+
+                            if (shape_[0] * shape_[1] * shape_[2] != numberOfVertices)
+                                throw std::runtime_error("the tiling does not match the number of vertices");
+
+                            for (std::size_t d = 0; d < 3; ++d)
+                                tiles_[d] = (shape_[d] + tileSize_ - 1) / tileSize_;
+                        }
+
+                        std::size_t numberOfTiles() const
+                        {
+                            return tiles_[0] * tiles_[1] * tiles_[2];
+                        }
+
+                        std::size_t tileOfVertex(std::size_t v) const
+                        {
+                            std::size_t t = 0;
+                            std::size_t stride = 1;
+                            for (std::size_t d = 0; d < 3; ++d)
+                            {
+                                t += (v % shape_[d]) / tileSize_ * stride;
+                                v /= shape_[d];
+                                stride *= tiles_[d];
+                            }
+                            return t;
+                        }
+
+                        /// Axis-aligned box [begin, end) of voxels.
+                        struct Box
+                        {
+                            std::size_t begin[3];
+                            std::size_t end[3];
+
+                            std::size_t numberOfVertices() const
+                            {
+                                return (end[0] - begin[0]) * (end[1] - begin[1]) * (end[2] - begin[2]);
+                            }
+                        };
+
+                        Box tile(std::size_t t) const
+                        {
+                            Box box;
+                            for (std::size_t d = 0; d < 3; ++d)
+                            {
+                                box.begin[d] = t % tiles_[d] * tileSize_;
+                                box.end[d] = std::min(box.begin[d] + tileSize_, shape_[d]);
+                                t /= tiles_[d];
+                            }
+                            return box;
+                        }
+
+                        Box margin(std::size_t t) const
+                        {
+                            auto box = tile(t);
+                            for (std::size_t d = 0; d < 3; ++d)
+                            {
+                                box.begin[d] = box.begin[d] > overlap_ ? box.begin[d] - overlap_ : 0;
+                                box.end[d] = std::min(box.end[d] + overlap_, shape_[d]);
+                            }
+                            return box;
+                        }
+
+                        /// Tiles that can hold vertices of the box with margin of tile t. As the
+                        /// margin is at most one tile wide, these are t and its direct neighbours.
+                        std::vector<std::size_t> neighbourhood(std::size_t t) const
+                        {
+                            std::size_t c[3];
+                            for (std::size_t d = 0; d < 3; ++d)
+                            {
+                                c[d] = t % tiles_[d];
+                                t /= tiles_[d];
+                            }
+
+                            std::vector<std::size_t> tiles;
+                            for (std::size_t z = c[2] > 0 ? c[2] - 1 : 0; z <= std::min(c[2] + 1, tiles_[2] - 1); ++z)
+                                for (std::size_t y = c[1] > 0 ? c[1] - 1 : 0; y <= std::min(c[1] + 1, tiles_[1] - 1); ++y)
+                                    for (std::size_t x = c[0] > 0 ? c[0] - 1 : 0; x <= std::min(c[0] + 1, tiles_[0] - 1); ++x)
+                                        tiles.push_back(x + tiles_[0] * (y + tiles_[1] * z));
+                            return tiles;
+                        }
+
+                        /// Index of v inside box, or numberOfVertices() of the box if v lies outside.
+                        std::size_t localIndex(Box const& box, std::size_t v) const
+                        {
+                            std::size_t local = 0;
+                            std::size_t stride = 1;
+                            for (std::size_t d = 0; d < 3; ++d)
+                            {
+                                auto const c = v % shape_[d];
+                                if (c < box.begin[d] || c >= box.end[d])
+                                    return box.numberOfVertices();
+                                local += (c - box.begin[d]) * stride;
+                                stride *= box.end[d] - box.begin[d];
+                                v /= shape_[d];
+                            }
+                            return local;
+                        }
+
+                        std::size_t globalIndex(std::size_t x, std::size_t y, std::size_t z) const
+                        {
+                            return x + shape_[0] * (y + shape_[1] * z);
+                        }
+
+                    private:
+                        std::size_t shape_[3];
+                        std::size_t tiles_[3];
+                        std::size_t tileSize_;
+                        std::size_t overlap_;
+                };
+
+                /// Edges of a graph grouped by the tile of their first vertex, in CSR form.
+                struct TileBuckets
+                {
+                    template<typename GRAPH>
+                        TileBuckets(GRAPH const& graph, GridTiles const& tiles, ThreadPool& pool) :
+                            offsets(tiles.numberOfTiles() + 1, 0),
+                            edges(graph.numberOfEdges())
+                        {
+                            // every thread counts and then fills one contiguous range of edges,
+                            // which keeps the edges of each bucket in order
+                            auto const chunks = pool.numberOfThreads();
+                            auto const chunk_size = (graph.numberOfEdges() + chunks - 1) / chunks;
+                            std::vector<std::vector<std::size_t>> counts(chunks, std::vector<std::size_t>(tiles.numberOfTiles(), 0));
+
+                            pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                    {
+                                    auto const end = std::min(graph.numberOfEdges(), (c + 1) * chunk_size);
+                                    for (auto e = c * chunk_size; e < end; ++e)
+                                        ++counts[c][tiles.tileOfVertex(graph.vertexOfEdge(e, 0))];
+                                    });
+
+                            std::size_t offset = 0;
+                            for (std::size_t t = 0; t < tiles.numberOfTiles(); ++t)
+                            {
+                                offsets[t] = offset;
+                                for (std::size_t c = 0; c < chunks; ++c)
+                                {
+                                    auto const count = counts[c][t];
+                                    counts[c][t] = offset;
+                                    offset += count;
+                                }
+                            }
+                            offsets.back() = offset;
+
+                            pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                    {
+                                    auto const end = std::min(graph.numberOfEdges(), (c + 1) * chunk_size);
+                                    for (auto e = c * chunk_size; e < end; ++e)
+                                        edges[counts[c][tiles.tileOfVertex(graph.vertexOfEdge(e, 0))]++] = e;
+                                    });
+                        }
+
+                    std::vector<std::size_t> offsets;
+                    std::vector<std::size_t> edges;
+                };
+
+                /// Tiled BEC or BEC-cut (RULE) on a grid graph.
+                ///
+                /// 1. Every tile is contracted sequentially on the subgraphs induced by its
+                ///    box with margin; the clusters of the vertices of the tile itself are
+                ///    kept. Only the graphs of the tiles in progress are held in memory.
+                ///    VISITOR sees this as the phase Tiles.
+                /// 2. The clusters are split into connected components of the original graph
+                ///    by a ConcurrentPartition, and their graphs with summed lifted costs are
+                ///    built by ClusterGraphs, on the threads of the tiling (phase Stitching).
+                /// 3. A stitching contraction, with the settings given, continues on the graphs
+                ///    of these clusters, starting from the number of merges that formed them
+                ///    (see BalancedEdgeContraction). It joins the clusters that the tile
+                ///    boundaries cut apart. VISITOR receives the callbacks of this
+                ///    contraction and of the final labeling.
+                ///
+                /// All contractions use the types of POLICY (a ContractionPolicy).
+                ///
+                template<typename POLICY, typename RULE, typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename ELA, typename VISITOR>
+                    void tiledBalancedEdgeContraction(
+                            const ORIGGRAPH& original_graph,
+                            const LIFTGRAPH& lifted_graph,
+                            EVA const& edge_values,
+                            ELA& edge_labels,
+                            BalancedEdgeContractionTiling const& tiling,
+                            BalancedEdgeContractionSettings const& settings,
+                            VISITOR& visitor
+                            )
+                    {
+                        typedef typename POLICY::value_type value_type;
+                        typedef std::vector<value_type> Costs;
+
+                        auto const n = original_graph.numberOfVertices();
+                        auto const npos = std::numeric_limits<std::size_t>::max();
+
+                        GridTiles const tiles(tiling, n);
+                        ThreadPool pool(tiling.numberOfThreads);
+
+                        visitor.beginPhase(BalancedEdgeContractionPhase::Tiles);
+
+                        TileBuckets const original_buckets(original_graph, tiles, pool);
+                        TileBuckets const lifted_buckets(lifted_graph, tiles, pool);
+
+                        // labels[v]: the smallest vertex of the tile of v in the same cluster as v,
+                        // so that labels from different tiles never collide
+                        std::vector<std::size_t> labels(n);
+
+                        pool.parallelFor(tiles.numberOfTiles(), [&](std::size_t, std::size_t t)
+                                {
+                                auto const box = tiles.margin(t);
+                                auto const m = box.numberOfVertices();
+                                auto const neighbourhood = tiles.neighbourhood(t);
+
+                                TileGraph local_original(m);
+                                TileGraph local_lifted(m);
+                                Costs local_costs;
+
+                                for (auto u : neighbourhood)
+                                    for (auto k = original_buckets.offsets[u]; k < original_buckets.offsets[u + 1]; ++k)
+                                    {
+                                        auto const e = original_buckets.edges[k];
+                                        auto const a = tiles.localIndex(box, original_graph.vertexOfEdge(e, 0));
+                                        auto const b = tiles.localIndex(box, original_graph.vertexOfEdge(e, 1));
+                                        if (a != m && b != m)
+                                            local_original.insertEdge(a, b);
+                                    }
+
+                                for (auto u : neighbourhood)
+                                    for (auto k = lifted_buckets.offsets[u]; k < lifted_buckets.offsets[u + 1]; ++k)
+                                    {
+                                        auto const e = lifted_buckets.edges[k];
+                                        auto const a = tiles.localIndex(box, lifted_graph.vertexOfEdge(e, 0));
+                                        auto const b = tiles.localIndex(box, lifted_graph.vertexOfEdge(e, 1));
+                                        if (a != m && b != m)
+                                        {
+                                            local_lifted.insertEdge(a, b);
+                                            local_costs.push_back(static_cast<value_type>(edge_values[e]));
+                                        }
+                                    }
+
+                                std::vector<std::size_t> local_labels(m);
+                                {
+                                    BalancedEdgeContractionVisitor local_visitor;
+                                    BalancedEdgeContraction<POLICY, TileGraph, TileGraph, Costs, RULE, BalancedEdgeContractionVisitor>
+                                        bec(local_original, local_lifted, local_costs, local_visitor);
+                                    bec.run(BalancedEdgeContractionSettings());
+                                    bec.labelVertices(local_labels);
+                                }
+
+                                std::vector<std::size_t> first(m, npos);
+                                auto const core = tiles.tile(t);
+                                for (auto z = core.begin[2]; z < core.end[2]; ++z)
+                                    for (auto y = core.begin[1]; y < core.end[1]; ++y)
+                                        for (auto x = core.begin[0]; x < core.end[0]; ++x)
+                                        {
+                                            auto const v = tiles.globalIndex(x, y, z);
+                                            auto& label = first[local_labels[tiles.localIndex(box, v)]];
+                                            if (label == npos)
+                                                label = v;
+                                            labels[v] = label;
+                                        }
+                                });
+
+                        visitor.endPhase(BalancedEdgeContractionPhase::Tiles);
+                        visitor.beginPhase(BalancedEdgeContractionPhase::Stitching);
+
+                        // clusters: connected components of the original graph with equal labels,
+                        // numbered in the order of their smallest vertex
+                        std::size_t k = 0;
+                        {
+                            ConcurrentPartition partition(n);
+                            auto const chunks = pool.numberOfThreads();
+                            auto const m = original_graph.numberOfEdges();
+                            auto const chunk_size = (m + chunks - 1) / chunks;
+                            pool.parallelFor(chunks, [&](std::size_t, std::size_t c)
+                                    {
+                                    auto const end = std::min(m, (c + 1) * chunk_size);
+                                    for (auto e = c * chunk_size; e < end; ++e)
+                                    {
+                                        auto const a = original_graph.vertexOfEdge(e, 0);
+                                        auto const b = original_graph.vertexOfEdge(e, 1);
+                                        if (labels[a] == labels[b])
+                                            partition.merge(a, b);
+                                    }
+                                    });
+
+                            k = numberClusters(partition, labels, pool);
+                        }
+
+                        ClusterGraphs<value_type> const clusters(original_graph, lifted_graph, edge_values, labels, k, pool);
+
+                        visitor.endPhase(BalancedEdgeContractionPhase::Stitching);
+
+                        std::vector<std::size_t> cluster_labels(k);
+                        {
+                            BalancedEdgeContraction<POLICY, TileGraph, TileGraph, Costs, RULE, VISITOR>
+                                bec(clusters.original, clusters.lifted, clusters.costs, clusters.sizes, n, visitor);
+                            bec.run(settings);
+                            bec.labelVertices(cluster_labels);
+                        }
+
+                        visitor.beginPhase(BalancedEdgeContractionPhase::Labeling);
+
+                        for (std::size_t e = 0; e < lifted_graph.numberOfEdges(); ++e)
+                            edge_labels[e] = cluster_labels[labels[lifted_graph.vertexOfEdge(e, 0)]] == cluster_labels[labels[lifted_graph.vertexOfEdge(e, 1)]] ? 0 : 1;
+
+                        visitor.endPhase(BalancedEdgeContractionPhase::Labeling);
+                    }
+
+            } // namespace detail
+
+        } // namespace multicut_lifted
+    } // namespace graph
+} // namespace andres
+
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_TILED_HXX
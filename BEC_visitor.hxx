@@ -0,0 +1,201 @@
+#pragma once
+#ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_VISITOR_HXX
+#define ANDRES_GRAPH_MULTICUT_LIFTED_BEC_VISITOR_HXX
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+namespace andres {
+    namespace graph {
+        namespace multicut_lifted {
+
+            /// Phases of BEC and BEC-cut, in the order in which they run.
+            ///
+            enum class BalancedEdgeContractionPhase
+            {
+                PreContraction, ///< contract strongly attractive edges in parallel (optional)
+                Tiles,          ///< contract the tiles of the tiled mode (tiled mode only)
+                Stitching,      ///< build the graphs of the tile clusters (tiled mode only)
+                GraphCopy,      ///< build the contracted original and lifted graphs
+                QueueBuild,     ///< compute the initial priorities
+                Contraction,    ///< greedy contraction
+                Labeling        ///< write the edge labels
+            };
+
+            /// Visitor of BEC and BEC-cut that does nothing.
+            ///
+            /// All callbacks are empty inline functions, so a solver instantiated with
+            /// this visitor (the default) compiles to the same code as without one.
+            /// Other visitors may derive from it and override (hide) any subset of the
+            /// callbacks. Callbacks are never invoked concurrently, also not in the
+            /// parallel mode.
+            ///
+            struct BalancedEdgeContractionVisitor
+            {
+                void beginPhase(BalancedEdgeContractionPhase)
+                {}
+
+                void endPhase(BalancedEdgeContractionPhase)
+                {}
+
+                /// The pre-contraction joined numberOfVertices vertices into numberOfClusters clusters.
+                void preContracted(std::size_t /*numberOfVertices*/, std::size_t /*numberOfClusters*/)
+                {}
+
+                /// The graphs are copied and numberOfQueuedEdges edges are candidates for contraction.
+                void initialized(std::size_t /*numberOfVertices*/, std::size_t /*numberOfQueuedEdges*/)
+                {}
+
+                /// An edge of the given priority (RULE::Edge::w) joined clusters of the given sizes.
+                template<typename T>
+                    void merged(T /*priority*/, T /*stableSize*/, T /*mergeSize*/)
+                    {}
+
+                /// A candidate was taken from the queue but not contracted. The queue holds
+                /// no stale entries, so this happens only in the parallel mode, when the
+                /// neighbourhood of the candidate overlaps that of an earlier candidate of
+                /// the same round; the candidate goes back to the queue.
+                template<typename T>
+                    void skipped(T /*priority*/)
+                    {}
+
+                /// The contraction stopped after numberOfMerges merges.
+                void terminated(std::size_t /*numberOfMerges*/, std::size_t /*numberOfQueuedEdges*/)
+                {}
+            };
+
+            /// Visitor of BEC and BEC-cut that measures the time of every phase and counts events.
+            ///
+            class BalancedEdgeContractionProfilingVisitor : public BalancedEdgeContractionVisitor
+            {
+                public:
+                    typedef std::chrono::steady_clock clock_type;
+
+                    void beginPhase(BalancedEdgeContractionPhase)
+                    {
+                        start_ = clock_type::now();
+                    }
+
+                    void endPhase(BalancedEdgeContractionPhase phase)
+                    {
+                        seconds_[static_cast<std::size_t>(phase)] += std::chrono::duration<double>(clock_type::now() - start_).count();
+                    }
+
+                    void preContracted(std::size_t numberOfVertices, std::size_t numberOfClusters)
+                    {
+                        numberOfPreMerges_ = numberOfVertices - numberOfClusters;
+                    }
+
+                    void initialized(std::size_t numberOfVertices, std::size_t numberOfQueuedEdges)
+                    {
+                        numberOfVertices_ = numberOfVertices;
+                        numberOfInitialCandidates_ = numberOfQueuedEdges;
+                    }
+
+                    template<typename T>
+                        void merged(T priority, T stableSize, T mergeSize)
+                        {
+                            ++numberOfMerges_;
+                            lastPriority_ = static_cast<double>(priority);
+                            largestCluster_ = std::max(largestCluster_, static_cast<double>(stableSize + mergeSize));
+                        }
+
+                    template<typename T>
+                        void skipped(T)
+                        {
+                            ++numberOfSkips_;
+                        }
+
+                    void terminated(std::size_t, std::size_t numberOfQueuedEdges)
+                    {
+                        numberOfRemainingCandidates_ = numberOfQueuedEdges;
+                    }
+
+                    double seconds(BalancedEdgeContractionPhase phase) const
+                    {
+                        return seconds_[static_cast<std::size_t>(phase)];
+                    }
+
+                    double totalSeconds() const
+                    {
+                        double total = 0;
+                        for (std::size_t i = 0; i < numberOfPhases; ++i)
+                            total += seconds_[i];
+                        return total;
+                    }
+
+                    std::size_t numberOfMerges() const
+                    {
+                        return numberOfMerges_;
+                    }
+
+                    /// Number of merges of the pre-contraction, which merged() does not see.
+                    std::size_t numberOfPreMerges() const
+                    {
+                        return numberOfPreMerges_;
+                    }
+
+                    std::size_t numberOfSkips() const
+                    {
+                        return numberOfSkips_;
+                    }
+
+                    std::size_t numberOfInitialCandidates() const
+                    {
+                        return numberOfInitialCandidates_;
+                    }
+
+                    std::size_t numberOfRemainingCandidates() const
+                    {
+                        return numberOfRemainingCandidates_;
+                    }
+
+                    /// Priority of the last merged edge.
+                    double lastPriority() const
+                    {
+                        return lastPriority_;
+                    }
+
+                    /// Number of vertices of the largest cluster formed by a merge.
+                    double largestCluster() const
+                    {
+                        return largestCluster_;
+                    }
+
+                    void print(std::ostream& out) const
+                    {
+                        static char const* const names[numberOfPhases] = { "pre-contraction", "tiles", "stitching", "graph copy", "queue build", "contraction", "labeling" };
+
+                        for (std::size_t i = 0; i < numberOfPhases; ++i)
+                            out << names[i] << ": " << seconds_[i] << " s\n";
+                        out << "vertices: " << numberOfVertices_
+                            << ", initial candidates: " << numberOfInitialCandidates_
+                            << ", pre-merges: " << numberOfPreMerges_
+                            << ", merges: " << numberOfMerges_
+                            << ", skips: " << numberOfSkips_
+                            << ", remaining candidates: " << numberOfRemainingCandidates_
+                            << ", largest cluster: " << largestCluster_ << "\n";
+                    }
+
+                private:
+                    static std::size_t const numberOfPhases = static_cast<std::size_t>(BalancedEdgeContractionPhase::Labeling) + 1;
+
+                    clock_type::time_point start_;
+                    double seconds_[numberOfPhases] { 0, 0, 0, 0, 0, 0, 0 };
+                    std::size_t numberOfVertices_ { 0 };
+                    std::size_t numberOfInitialCandidates_ { 0 };
+                    std::size_t numberOfRemainingCandidates_ { 0 };
+                    std::size_t numberOfPreMerges_ { 0 };
+                    std::size_t numberOfMerges_ { 0 };
+                    std::size_t numberOfSkips_ { 0 };
+                    double lastPriority_ { 0 };
+                    double largestCluster_ { 1 };
+            };
+
+        } // namespace multicut_lifted
+    } // namespace graph
+} // namespace andres
+
+#endif // #ifndef ANDRES_GRAPH_MULTICUT_LIFTED_BEC_VISITOR_HXX
@@ -0,0 +1,588 @@
+// Benchmark of BEC and BEC-cut on synthetic lifted multicut instances.
+//
+// usage: bec-benchmark [--size N | --width W --height H] [--radius R]
+//                      [--costs image|random] [--region-size S] [--noise SIGMA]
+//                      [--seed SEED] [--solver bec|bec-cut|both]
+//                      [--threads T] [--batch-size B] [--nondeterministic]
+//                      [--profile] [--csv] [--save FILE | --load FILE]
+//                      [--tile-size T [--overlap O]] [--patch S] [--compact]
+//                      [--pre-contract C [--pre-contract-threads T]]
+//
+// --save writes the generated instance in the binary format of BEC_instance.hxx,
+// --load solves a binary instance (mapped into memory) instead of a generated one.
+// --tile-size also runs the tiled solvers and reports their objective gap.
+// --patch also runs the incremental solvers: it negates the costs of the lifted
+// edges in a central S x S patch and times the re-solve against a cold solve.
+// --compact runs all solvers with CompactContractionPolicy (32-bit indices, float).
+// --pre-contract contracts all original edges of cost greater than C in parallel
+// (on --pre-contract-threads threads, default all) before the greedy contraction
+// of BEC and BEC-cut.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "andres/graph/multicut-lifted/BEC.hxx"
+#include "andres/graph/multicut-lifted/BEC_cut.hxx"
+#include "andres/graph/multicut-lifted/BEC_instance.hxx"
+
+#include "BEC_grid_instance.hxx"
+
+namespace {
+
+    struct Options
+    {
+        std::size_t width { 256 };
+        std::size_t height { 256 };
+        double radius { 2 };
+        bec_benchmark::Costs costs { bec_benchmark::Costs::Image };
+        std::size_t regionSize { 32 };
+        double noise { 0.8 };
+        unsigned int seed { 42 };
+        std::string solver { "both" };
+        andres::graph::multicut_lifted::BalancedEdgeContractionSettings settings;
+        bool profile { false };
+        bool csv { false };
+        std::string save;
+        std::string load;
+        andres::graph::multicut_lifted::BalancedEdgeContractionTiling tiling;
+        std::size_t patch { 0 };
+        bool compact { false };
+    };
+
+    // path is the file of a loaded instance, empty for a generated one
+    struct InstanceInfo
+    {
+        std::size_t width;
+        std::size_t height;
+        std::size_t numberOfVertices;
+        std::size_t numberOfLiftedEdges;
+        std::string path;
+    };
+
+    // CSV field, quoted so that any file name is one field
+    std::string csvField(std::string const& text)
+    {
+        std::string field = "\"";
+        for (auto c : text)
+        {
+            if (c == '"')
+                field += '"';
+            field += c;
+        }
+        return field + "\"";
+    }
+
+    struct Result
+    {
+        double seconds;
+        std::size_t clusters;
+        double objective;
+        double peakMemory;
+        bool peakMemoryIsolated;
+    };
+
+    template<typename POLICY>
+    struct BEC
+    {
+        template<typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename VISITOR>
+            void operator()(ORIGGRAPH const& original_graph, LIFTGRAPH const& lifted_graph, EVA const& edge_values, std::vector<char>& edge_labels,
+                    andres::graph::multicut_lifted::BalancedEdgeContractionSettings const& settings, VISITOR& visitor) const
+            {
+                andres::graph::multicut_lifted::balancedEdgeContraction<POLICY>(
+                        original_graph, lifted_graph, edge_values, edge_labels, settings, visitor);
+            }
+    };
+
+    template<typename POLICY>
+    struct BECCut
+    {
+        template<typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename VISITOR>
+            void operator()(ORIGGRAPH const& original_graph, LIFTGRAPH const& lifted_graph, EVA const& edge_values, std::vector<char>& edge_labels,
+                    andres::graph::multicut_lifted::BalancedEdgeContractionSettings const& settings, VISITOR& visitor) const
+            {
+                andres::graph::multicut_lifted::balancedEdgeContraction_cut<POLICY>(
+                        original_graph, lifted_graph, edge_values, edge_labels, settings, visitor);
+            }
+    };
+
+    template<typename POLICY>
+    struct BECTiled
+    {
+        andres::graph::multicut_lifted::BalancedEdgeContractionTiling tiling;
+
+        template<typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename VISITOR>
+            void operator()(ORIGGRAPH const& original_graph, LIFTGRAPH const& lifted_graph, EVA const& edge_values, std::vector<char>& edge_labels,
+                    andres::graph::multicut_lifted::BalancedEdgeContractionSettings const& settings, VISITOR& visitor) const
+            {
+                andres::graph::multicut_lifted::balancedEdgeContraction_tiled<POLICY>(
+                        original_graph, lifted_graph, edge_values, edge_labels, tiling, settings, visitor);
+            }
+    };
+
+    template<typename POLICY>
+    struct BECCutTiled
+    {
+        andres::graph::multicut_lifted::BalancedEdgeContractionTiling tiling;
+
+        template<typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename VISITOR>
+            void operator()(ORIGGRAPH const& original_graph, LIFTGRAPH const& lifted_graph, EVA const& edge_values, std::vector<char>& edge_labels,
+                    andres::graph::multicut_lifted::BalancedEdgeContractionSettings const& settings, VISITOR& visitor) const
+            {
+                andres::graph::multicut_lifted::balancedEdgeContraction_cut_tiled<POLICY>(
+                        original_graph, lifted_graph, edge_values, edge_labels, tiling, settings, visitor);
+            }
+    };
+
+    void usage()
+    {
+        std::cerr << "usage: bec-benchmark [--size N | --width W --height H] [--radius R]\n"
+                  << "                     [--costs image|random] [--region-size S] [--noise SIGMA]\n"
+                  << "                     [--seed SEED] [--solver bec|bec-cut|both]\n"
+                  << "                     [--threads T] [--batch-size B] [--nondeterministic]\n"
+                  << "                     [--profile] [--csv] [--save FILE | --load FILE]\n"
+                  << "                     [--tile-size T [--overlap O]] [--patch S] [--compact]\n"
+                  << "                     [--pre-contract C [--pre-contract-threads T]]\n";
+    }
+
+    Options parse(int argc, char** argv)
+    {
+        Options options;
+        options.tiling.tileSize = 0;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string const arg = argv[i];
+            auto value = [&]() -> std::string
+            {
+                if (i + 1 >= argc)
+                    throw std::runtime_error("missing value for " + arg);
+                return argv[++i];
+            };
+
+            if (arg == "--size")
+                options.width = options.height = std::stoul(value());
+            else if (arg == "--width")
+                options.width = std::stoul(value());
+            else if (arg == "--height")
+                options.height = std::stoul(value());
+            else if (arg == "--radius")
+                options.radius = std::stod(value());
+            else if (arg == "--costs")
+                options.costs = bec_benchmark::parseCosts(value());
+            else if (arg == "--region-size")
+                options.regionSize = std::stoul(value());
+            else if (arg == "--noise")
+                options.noise = std::stod(value());
+            else if (arg == "--seed")
+                options.seed = static_cast<unsigned int>(std::stoul(value()));
+            else if (arg == "--solver")
+                options.solver = value();
+            else if (arg == "--threads")
+                options.settings.numberOfThreads = std::stoul(value());
+            else if (arg == "--batch-size")
+                options.settings.batchSize = std::stoul(value());
+            else if (arg == "--nondeterministic")
+                options.settings.deterministic = false;
+            else if (arg == "--profile")
+                options.profile = true;
+            else if (arg == "--csv")
+                options.csv = true;
+            else if (arg == "--save")
+                options.save = value();
+            else if (arg == "--load")
+                options.load = value();
+            else if (arg == "--tile-size")
+                options.tiling.tileSize = std::stoul(value());
+            else if (arg == "--overlap")
+                options.tiling.overlap = std::stoul(value());
+            else if (arg == "--patch")
+                options.patch = std::stoul(value());
+            else if (arg == "--compact")
+                options.compact = true;
+            else if (arg == "--pre-contract")
+                options.settings.preContractionThreshold = std::stod(value());
+            else if (arg == "--pre-contract-threads")
+                options.settings.preContractionThreads = std::stoul(value());
+            else if (arg == "--help" || arg == "-h")
+            {
+                usage();
+                std::exit(0);
+            }
+            else
+                throw std::runtime_error("unknown option " + arg);
+        }
+
+        if (options.solver != "bec" && options.solver != "bec-cut" && options.solver != "both")
+            throw std::runtime_error("unknown solver " + options.solver);
+        if (!options.save.empty() && !options.load.empty())
+            throw std::runtime_error("--save and --load are exclusive");
+        if (options.tiling.tileSize != 0 && !options.load.empty())
+            throw std::runtime_error("--tile-size needs a generated grid instance");
+        if (options.patch != 0 && !options.load.empty())
+            throw std::runtime_error("--patch needs a generated grid instance");
+
+        options.tiling.width = options.width;
+        options.tiling.height = options.height;
+        options.tiling.numberOfThreads = options.settings.numberOfThreads;
+
+        return options;
+    }
+
+    // Peak resident set size in bytes. On Linux the peak is read from VmHWM, which
+    // resetPeakMemory() can set back to the current RSS, so every solver is measured
+    // on its own; elsewhere ru_maxrss is used and the peak covers the whole process.
+    double peakMemory()
+    {
+        std::ifstream status("/proc/self/status");
+        for (std::string line; std::getline(status, line); )
+            if (line.compare(0, 6, "VmHWM:") == 0)
+                return std::stod(line.substr(6)) * 1024.0;
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return static_cast<double>(usage.ru_maxrss);
+#else
+        return static_cast<double>(usage.ru_maxrss) * 1024.0;
+#endif
+    }
+
+    bool resetPeakMemory()
+    {
+        std::ofstream clear_refs("/proc/self/clear_refs");
+        clear_refs << "5";
+        clear_refs.flush();
+        return static_cast<bool>(clear_refs);
+    }
+
+    std::size_t find(std::vector<std::size_t>& parents, std::size_t v)
+    {
+        while (parents[v] != v)
+            v = parents[v] = parents[parents[v]];
+        return v;
+    }
+
+    template<typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename SOLVER, typename VISITOR>
+        Result run(Options const& options, ORIGGRAPH const& original_graph, LIFTGRAPH const& lifted_graph, EVA const& edge_values,
+                SOLVER const& solver, VISITOR& visitor)
+        {
+            std::vector<char> edge_labels(lifted_graph.numberOfEdges());
+
+            Result result;
+            result.peakMemoryIsolated = resetPeakMemory();
+
+            auto const start = std::chrono::steady_clock::now();
+            solver(original_graph, lifted_graph, edge_values, edge_labels, options.settings, visitor);
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            result.peakMemory = peakMemory();
+
+            // clusters are the components of the graph of uncut lifted edges
+            std::vector<std::size_t> parents(lifted_graph.numberOfVertices());
+            std::iota(parents.begin(), parents.end(), std::size_t());
+            result.clusters = parents.size();
+            result.objective = 0;
+
+            for (std::size_t e = 0; e < lifted_graph.numberOfEdges(); ++e)
+                if (edge_labels[e])
+                    result.objective += edge_values[e];
+                else
+                {
+                    auto a = find(parents, lifted_graph.vertexOfEdge(e, 0));
+                    auto b = find(parents, lifted_graph.vertexOfEdge(e, 1));
+                    if (a != b)
+                    {
+                        parents[a] = b;
+                        --result.clusters;
+                    }
+                }
+
+            return result;
+        }
+
+    void report(Options const& options, InstanceInfo const& instance, std::string const& name, Result const& result)
+    {
+        auto const n = instance.numberOfVertices;
+        auto const merges = n - result.clusters;
+        auto const mb = 1024.0 * 1024.0;
+
+        // the grid fields describe generated instances only; a loaded one is named by its file
+        if (options.csv && instance.path.empty())
+            std::printf("%s,%zu,%zu,%g,%s,%u,%zu,%zu,%zu,%.6f,%zu,%.1f,%zu,%.6f,%.1f,\n",
+                    name.c_str(),
+                    instance.width, instance.height, options.radius,
+                    options.costs == bec_benchmark::Costs::Image ? "image" : "random", options.seed,
+                    n, instance.numberOfLiftedEdges,
+                    options.settings.numberOfThreads,
+                    result.seconds, merges, merges / result.seconds, result.clusters,
+                    result.objective, result.peakMemory / mb);
+        else if (options.csv)
+            std::printf("%s,,,,loaded,,%zu,%zu,%zu,%.6f,%zu,%.1f,%zu,%.6f,%.1f,%s\n",
+                    name.c_str(),
+                    n, instance.numberOfLiftedEdges,
+                    options.settings.numberOfThreads,
+                    result.seconds, merges, merges / result.seconds, result.clusters,
+                    result.objective, result.peakMemory / mb, csvField(instance.path).c_str());
+        else
+            std::printf("%-9s %10.3f %12zu %12.0f %10zu %18.6f %12.1f%s\n",
+                    name.c_str(), result.seconds, merges, merges / result.seconds, result.clusters,
+                    result.objective, result.peakMemory / mb, result.peakMemoryIsolated ? "" : " (process)");
+    }
+
+    // the profiling visitor is only instantiated with --profile, so that the
+    // plain timings are those of the default, callback-free solver
+    template<typename ORIGGRAPH, typename LIFTGRAPH, typename EVA, typename SOLVER>
+        Result benchmark(Options const& options, InstanceInfo const& instance,
+                ORIGGRAPH const& original_graph, LIFTGRAPH const& lifted_graph, EVA const& edge_values,
+                std::string const& name, SOLVER const& solver)
+        {
+            if (options.profile)
+            {
+                andres::graph::multicut_lifted::BalancedEdgeContractionProfilingVisitor visitor;
+                auto const result = run(options, original_graph, lifted_graph, edge_values, solver, visitor);
+                report(options, instance, name, result);
+                if (!options.csv)
+                {
+                    std::fflush(stdout);
+                    visitor.print(std::cout);
+                    std::cout << std::endl;
+                }
+                return result;
+            }
+            else
+            {
+                andres::graph::multicut_lifted::BalancedEdgeContractionVisitor visitor;
+                auto const result = run(options, original_graph, lifted_graph, edge_values, solver, visitor);
+                report(options, instance, name, result);
+                return result;
+            }
+        }
+
+    // the gap is positive when the tiled objective (sum of cut costs) is larger
+    void reportGap(Options const& options, Result const& monolithic, Result const& tiled)
+    {
+        if (options.csv)
+            return;
+
+        auto const gap = tiled.objective - monolithic.objective;
+        std::printf("%-9s %10.2fx %59.6f (%+.3f%%)\n", "  tiled", monolithic.seconds / tiled.seconds,
+                gap, 100.0 * gap / std::abs(monolithic.objective));
+    }
+
+    void printHeader(Options const& options)
+    {
+        if (options.csv)
+            std::printf("solver,width,height,radius,costs,seed,vertices,lifted_edges,threads,seconds,merges,merges_per_second,clusters,objective,peak_rss_mb,instance\n");
+        else
+        {
+            std::printf("threads:  %zu%s\n", options.settings.numberOfThreads,
+                    options.settings.numberOfThreads == 1 ? " (sequential)" : (options.settings.deterministic ? " (batched, deterministic)" : " (batched)"));
+            if (options.settings.preContractionThreshold < std::numeric_limits<double>::infinity())
+            {
+                if (options.settings.preContractionThreads == 0)
+                    std::printf("pre-contraction of original edges of cost > %g on all hardware threads\n", options.settings.preContractionThreshold);
+                else
+                    std::printf("pre-contraction of original edges of cost > %g on %zu threads\n", options.settings.preContractionThreshold, options.settings.preContractionThreads);
+            }
+            if (options.tiling.tileSize != 0)
+                std::printf("tiles:    %zu, overlap %zu (*-t: tiled solver; below the monolithic one: speed-up and objective gap of the tiled one)\n",
+                        options.tiling.tileSize, options.tiling.overlap);
+            if (options.compact)
+                std::printf("types:    32-bit indices, float costs (CompactContractionPolicy)\n");
+            std::printf("\n%-9s %10s %12s %12s %10s %18s %12s\n",
+                    "solver", "time [s]", "merges", "merges/s", "clusters", "objective", "peak RSS [MB]");
+        }
+    }
+
+    template<typename POLICY, typename ORIGGRAPH, typename LIFTGRAPH, typename EVA>
+        void benchmarkSolvers(Options const& options, InstanceInfo const& instance,
+                ORIGGRAPH const& original_graph, LIFTGRAPH const& lifted_graph, EVA const& edge_values)
+        {
+            bool const tiled = options.tiling.tileSize != 0;
+
+            // the tiled solver runs first, so that its peak memory is not that of the
+            // heap the monolithic solver leaves behind
+            if (options.solver != "bec-cut")
+            {
+                if (tiled)
+                {
+                    auto const result = benchmark(options, instance, original_graph, lifted_graph, edge_values, "bec-t", BECTiled<POLICY> { options.tiling });
+                    reportGap(options, benchmark(options, instance, original_graph, lifted_graph, edge_values, "bec", BEC<POLICY>()), result);
+                }
+                else
+                    benchmark(options, instance, original_graph, lifted_graph, edge_values, "bec", BEC<POLICY>());
+            }
+
+            if (options.solver != "bec")
+            {
+                if (tiled)
+                {
+                    auto const result = benchmark(options, instance, original_graph, lifted_graph, edge_values, "bec-cut-t", BECCutTiled<POLICY> { options.tiling });
+                    reportGap(options, benchmark(options, instance, original_graph, lifted_graph, edge_values, "bec-cut", BECCut<POLICY>()), result);
+                }
+                else
+                    benchmark(options, instance, original_graph, lifted_graph, edge_values, "bec-cut", BECCut<POLICY>());
+            }
+        }
+
+    template<typename ORIGGRAPH, typename LIFTGRAPH, typename EVA>
+        void benchmarkAll(Options const& options, InstanceInfo const& instance,
+                ORIGGRAPH const& original_graph, LIFTGRAPH const& lifted_graph, EVA const& edge_values)
+        {
+            printHeader(options);
+
+            if (options.compact)
+                benchmarkSolvers<andres::graph::multicut_lifted::CompactContractionPolicy>(options, instance, original_graph, lifted_graph, edge_values);
+            else
+                benchmarkSolvers<andres::graph::multicut_lifted::ContractionPolicy<>>(options, instance, original_graph, lifted_graph, edge_values);
+        }
+
+    double seconds(std::chrono::steady_clock::time_point const& start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // solves, changes the costs of a patch, solves again incrementally and from scratch
+    template<typename INCREMENTAL, typename SOLVER>
+        void benchmarkIncremental(Options const& options, bec_benchmark::GridInstance const& instance, std::string const& name, SOLVER const& solver)
+        {
+            typedef bec_benchmark::EdgeListGraph Graph;
+
+            auto start = std::chrono::steady_clock::now();
+            INCREMENTAL incremental(instance.original_graph, instance.lifted_graph, instance.edge_values, options.settings);
+            auto const initial = seconds(start);
+
+            auto const x0 = (instance.width - std::min(options.patch, instance.width)) / 2;
+            auto const y0 = (instance.height - std::min(options.patch, instance.height)) / 2;
+
+            auto edge_values = instance.edge_values;
+            std::size_t changed = 0;
+            for (std::size_t e = 0; e < edge_values.size(); ++e)
+            {
+                auto const v = instance.lifted_graph.vertexOfEdge(e, 0);
+                auto const x = v % instance.width;
+                auto const y = v / instance.width;
+                if (x >= x0 && x < x0 + options.patch && y >= y0 && y < y0 + options.patch)
+                {
+                    edge_values[e] = -edge_values[e];
+                    incremental.setEdgeValue(e, edge_values[e]);
+                    ++changed;
+                }
+            }
+            start = std::chrono::steady_clock::now();
+            incremental.run();
+            auto const resolve = seconds(start);
+
+            std::vector<char> edge_labels(edge_values.size());
+            incremental.labelEdges(edge_labels);
+            auto objective = 0.0;
+            for (std::size_t e = 0; e < edge_values.size(); ++e)
+                if (edge_labels[e])
+                    objective += edge_values[e];
+
+            andres::graph::multicut_lifted::BalancedEdgeContractionVisitor visitor;
+            auto const cold = run<Graph, Graph>(options, instance.original_graph, instance.lifted_graph, edge_values, solver, visitor);
+
+            if (options.csv)
+                return;
+
+            std::printf("%-9s initial solve %.3f s, %zu edges changed, re-solve %.4f s, cold solve %.3f s, objective %.6f (cold %.6f, %+.3f%%)\n",
+                    name.c_str(), initial, changed, resolve, cold.seconds, objective, cold.objective,
+                    100.0 * (objective - cold.objective) / std::abs(cold.objective));
+        }
+
+    template<typename POLICY>
+        void benchmarkIncrementals(Options const& options, bec_benchmark::GridInstance const& instance)
+        {
+            typedef bec_benchmark::EdgeListGraph Graph;
+
+            if (options.solver != "bec-cut")
+                benchmarkIncremental<andres::graph::multicut_lifted::IncrementalBalancedEdgeContraction<POLICY, Graph, Graph>>(options, instance, "bec-i", BEC<POLICY>());
+            if (options.solver != "bec")
+                benchmarkIncremental<andres::graph::multicut_lifted::IncrementalBalancedEdgeContraction_cut<POLICY, Graph, Graph>>(options, instance, "bec-cut-i", BECCut<POLICY>());
+        }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        auto const options = parse(argc, argv);
+        auto const mb = 1024.0 * 1024.0;
+
+        if (!options.load.empty())
+        {
+            auto const start = std::chrono::steady_clock::now();
+            andres::graph::multicut_lifted::MappedInstance<double> instance(options.load, true);
+            auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            InstanceInfo const info { 0, 0, instance.originalGraph().numberOfVertices(), instance.liftedGraph().numberOfEdges(), options.load };
+
+            if (!options.csv)
+                std::printf("instance: %s\n          %zu vertices, %zu original edges, %zu lifted edges, mapped and validated in %.6f s\n",
+                        options.load.c_str(), info.numberOfVertices, instance.originalGraph().numberOfEdges(),
+                        info.numberOfLiftedEdges, seconds);
+
+            benchmarkAll(options, info, instance.originalGraph(), instance.liftedGraph(), instance.edgeValues());
+            return 0;
+        }
+
+        auto const start = std::chrono::steady_clock::now();
+        bec_benchmark::GridInstance instance(options.width, options.height, options.radius, options.costs,
+                options.seed, options.regionSize, options.noise);
+        auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        InstanceInfo const info { instance.width, instance.height, instance.original_graph.numberOfVertices(), instance.lifted_graph.numberOfEdges(), std::string() };
+
+        if (!options.csv)
+        {
+            std::printf("instance: %zux%zu grid, lifted radius %g, %s costs, seed %u\n",
+                    instance.width, instance.height, options.radius,
+                    options.costs == bec_benchmark::Costs::Image ? "image" : "random", options.seed);
+            std::printf("          %zu vertices, %zu original edges, %zu lifted edges, %.1f MB, generated in %.3f s\n",
+                    info.numberOfVertices, instance.original_graph.numberOfEdges(),
+                    info.numberOfLiftedEdges, instance.memory() / mb, seconds);
+        }
+
+        if (!options.save.empty())
+        {
+            andres::graph::multicut_lifted::writeBinaryInstance<double>(options.save,
+                    instance.original_graph, instance.lifted_graph, instance.edge_values);
+            if (!options.csv)
+                std::printf("          saved to %s\n", options.save.c_str());
+        }
+
+        benchmarkAll(options, info, instance.original_graph, instance.lifted_graph, instance.edge_values);
+
+        if (options.patch != 0)
+        {
+            if (!options.csv)
+                std::printf("\n");
+            if (options.compact)
+                benchmarkIncrementals<andres::graph::multicut_lifted::CompactContractionPolicy>(options, instance);
+            else
+                benchmarkIncrementals<andres::graph::multicut_lifted::ContractionPolicy<>>(options, instance);
+        }
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        usage();
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+#pragma once
+#ifndef BEC_BENCHMARK_GRID_INSTANCE_HXX
+#define BEC_BENCHMARK_GRID_INSTANCE_HXX
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bec_benchmark {
+
+    /// Graph given by a flat list of edges, with the interface BEC and BEC-cut use.
+    ///
+    class EdgeListGraph
+    {
+        public:
+            EdgeListGraph(std::size_t numberOfVertices = 0) :
+                numberOfVertices_(numberOfVertices)
+        {}
+
+            std::size_t numberOfVertices() const
+            {
+                return numberOfVertices_;
+            }
+
+            std::size_t numberOfEdges() const
+            {
+                return vertices_.size() / 2;
+            }
+
+            std::size_t vertexOfEdge(std::size_t e, std::size_t j) const
+            {
+                return vertices_[2 * e + j];
+            }
+
+            void insertEdge(std::size_t a, std::size_t b)
+            {
+                vertices_.push_back(static_cast<std::uint32_t>(a));
+                vertices_.push_back(static_cast<std::uint32_t>(b));
+            }
+
+            void reserveEdges(std::size_t m)
+            {
+                vertices_.reserve(2 * m);
+            }
+
+            std::size_t memory() const
+            {
+                return vertices_.capacity() * sizeof(std::uint32_t);
+            }
+
+        private:
+            std::size_t numberOfVertices_;
+            std::vector<std::uint32_t> vertices_;
+    };
+
+    enum class Costs { Random, Image };
+
+    inline Costs parseCosts(std::string const& name)
+    {
+        if (name == "random")
+            return Costs::Random;
+        if (name == "image")
+            return Costs::Image;
+        throw std::runtime_error("unknown cost model: " + name);
+    }
+
+    /// Lifted multicut instance on a 2D pixel grid.
+    ///
+    /// The original graph is the 4-neighbourhood, vertex x + width * y. The lifted
+    /// graph contains every pair of pixels at Euclidean distance at most radius
+    /// (and thus all original edges). Positive costs are attractive.
+    ///
+    /// Costs::Random draws every cost from N(0.1, 1). Costs::Image simulates an
+    /// over-segmentation problem: the image is cut into Voronoi regions around
+    /// jittered seeds, roughly one per regionSize x regionSize block; a pair of
+    /// pixels gets +1 inside a region and -1 across regions, plus N(0, noise),
+    /// and the cost decays with the distance of the two pixels.
+    ///
+    struct GridInstance
+    {
+        GridInstance(
+                std::size_t _width,
+                std::size_t _height,
+                double radius,
+                Costs costs,
+                unsigned int seed = 42,
+                std::size_t regionSize = 32,
+                double noise = 0.8
+                ) :
+            width(_width),
+            height(_height),
+            original_graph(_width * _height),
+            lifted_graph(_width * _height)
+        {
+            if (width == 0 || height == 0)
+                throw std::runtime_error("grid must not be empty");
+            if (static_cast<double>(width) * static_cast<double>(height) >= 4294967295.0)
+                throw std::runtime_error("grid has too many vertices for 32-bit vertex indices");
+            if (radius < 1)
+                throw std::runtime_error("lifted radius must be at least 1");
+
+            std::mt19937_64 rng(seed);
+
+            std::vector<std::uint32_t> regions;
+            if (costs == Costs::Image)
+                regions = voronoiRegions(regionSize, rng);
+
+            auto const r = static_cast<std::ptrdiff_t>(std::floor(radius));
+            std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> offsets;
+            for (std::ptrdiff_t dy = 0; dy <= r; ++dy)
+                for (std::ptrdiff_t dx = -r; dx <= r; ++dx)
+                    if ((dy > 0 || dx > 0) && static_cast<double>(dx * dx + dy * dy) <= radius * radius)
+                        offsets.push_back(std::make_pair(dx, dy));
+
+            original_graph.reserveEdges(2 * width * height);
+            lifted_graph.reserveEdges(offsets.size() * width * height);
+            edge_values.reserve(offsets.size() * width * height);
+
+            std::normal_distribution<double> random_cost(0.1, 1.0);
+            std::normal_distribution<double> image_noise(0.0, noise);
+
+            for (std::size_t y = 0; y < height; ++y)
+                for (std::size_t x = 0; x < width; ++x)
+                {
+                    auto const v = x + width * y;
+
+                    if (x + 1 < width)
+                        original_graph.insertEdge(v, v + 1);
+                    if (y + 1 < height)
+                        original_graph.insertEdge(v, v + width);
+
+                    for (auto const& offset : offsets)
+                    {
+                        auto const xx = static_cast<std::ptrdiff_t>(x) + offset.first;
+                        auto const yy = static_cast<std::ptrdiff_t>(y) + offset.second;
+                        if (xx < 0 || xx >= static_cast<std::ptrdiff_t>(width) || yy >= static_cast<std::ptrdiff_t>(height))
+                            continue;
+
+                        auto const w = static_cast<std::size_t>(xx) + width * static_cast<std::size_t>(yy);
+                        lifted_graph.insertEdge(v, w);
+
+                        if (costs == Costs::Random)
+                            edge_values.push_back(random_cost(rng));
+                        else
+                        {
+                            auto const sign = regions[v] == regions[w] ? 1.0 : -1.0;
+                            auto const distance = std::sqrt(static_cast<double>(offset.first * offset.first + offset.second * offset.second));
+                            edge_values.push_back((sign + image_noise(rng)) / distance);
+                        }
+                    }
+                }
+        }
+
+        std::size_t memory() const
+        {
+            return original_graph.memory() + lifted_graph.memory() + edge_values.capacity() * sizeof(double);
+        }
+
+        std::size_t width;
+        std::size_t height;
+        EdgeListGraph original_graph;
+        EdgeListGraph lifted_graph;
+        std::vector<double> edge_values;
+
+        private:
+            std::vector<std::uint32_t> voronoiRegions(std::size_t regionSize, std::mt19937_64& rng) const
+            {
+                auto const cell = static_cast<std::ptrdiff_t>(regionSize == 0 ? 1 : regionSize);
+                auto const cells_x = (static_cast<std::ptrdiff_t>(width) + cell - 1) / cell;
+                auto const cells_y = (static_cast<std::ptrdiff_t>(height) + cell - 1) / cell;
+
+                std::uniform_real_distribution<double> jitter(0.0, static_cast<double>(cell));
+                std::vector<std::pair<double, double>> seeds(cells_x * cells_y);
+                for (std::ptrdiff_t cy = 0; cy < cells_y; ++cy)
+                    for (std::ptrdiff_t cx = 0; cx < cells_x; ++cx)
+                        seeds[cx + cells_x * cy] = std::make_pair(cx * cell + jitter(rng), cy * cell + jitter(rng));
+
+                // the nearest seed of a pixel lies in its own cell or one of the 8 around it
+                std::vector<std::uint32_t> regions(width * height);
+                for (std::size_t y = 0; y < height; ++y)
+                    for (std::size_t x = 0; x < width; ++x)
+                    {
+                        auto const cx = static_cast<std::ptrdiff_t>(x) / cell;
+                        auto const cy = static_cast<std::ptrdiff_t>(y) / cell;
+
+                        auto best = std::numeric_limits<double>::infinity();
+                        for (auto ny = cy - 1; ny <= cy + 1; ++ny)
+                            for (auto nx = cx - 1; nx <= cx + 1; ++nx)
+                            {
+                                if (nx < 0 || ny < 0 || nx >= cells_x || ny >= cells_y)
+                                    continue;
+
+                                auto const& s = seeds[nx + cells_x * ny];
+                                auto const d = (s.first - x) * (s.first - x) + (s.second - y) * (s.second - y);
+                                if (d < best)
+                                {
+                                    best = d;
+                                    regions[x + width * y] = static_cast<std::uint32_t>(nx + cells_x * ny);
+                                }
+                            }
+                    }
+
+                return regions;
+            }
+    };
+
+} // namespace bec_benchmark
+
+#endif // #ifndef BEC_BENCHMARK_GRID_INSTANCE_HXX